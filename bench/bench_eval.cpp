@@ -0,0 +1,55 @@
+// Tree-walk evaluator on small, expression-heavy snippets in the style of
+// test_evaluator.cpp. Each snippet is parsed once and evaluated repeatedly
+// in the global scope, so the numbers are dominated by per-node overhead
+// (dispatch, scope passing, value copies) rather than by allocation of
+// fresh scopes or data structures.
+
+#include "bench_util.h"
+#include "finescript/evaluator.h"
+#include "finescript/interner.h"
+#include "finescript/parser.h"
+
+using namespace finescript;
+
+namespace {
+
+struct Snippet {
+    const char* name;
+    const char* source;
+    int iterations;
+};
+
+const Snippet kSnippets[] = {
+    {"nested arithmetic", "((((a + b) * (c - d)) + ((a * c) - (b * d))) % 97)", 200000},
+    {"comparison chain", "(((a < b) and (c > d)) or ((a == c) and (b != d)))", 200000},
+    {"interpolation", "\"{a}:{b}:{c}:{d}\"", 100000},
+    {"field access", "(p.x + p.y + p.z + p.x)", 200000},
+    {"function call", "{add3 a b c}", 100000},
+    {"if/elif", "if (a > c) do 1 elif (b > c) do 2 else do 3 end", 200000},
+    {"array literal and index", "[a b c d][2]", 200000},
+};
+
+} // anonymous namespace
+
+int main() {
+    DefaultInterner interner;
+    auto globalScope = Scope::createGlobal();
+    Evaluator evaluator(interner, globalScope);
+
+    auto setup = std::shared_ptr<AstNode>(Parser::parse(R"(
+set a 7
+set b 11
+set c 3
+set d 5
+set p {=x 1 =y 2 =z 3}
+fn add3 [x y z] (x + y + z)
+)").release());
+    evaluator.eval(setup, globalScope);
+
+    std::printf("finescript: tree-walk expression evaluation\n");
+    for (const auto& s : kSnippets) {
+        auto ast = std::shared_ptr<AstNode>(Parser::parse(s.source).release());
+        bench::measure(s.name, s.iterations, [&] { evaluator.eval(ast, globalScope); });
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// DefaultInterner against the interner it replaced (a deque plus an
+// unordered_map, which needs an outside mutex once threads share it). The
+// workload is what parsing does: mostly hits on names already interned,
+// with a trickle of new ones. A second run looks at a big symbol set, the
+// size of a heavily modded server's block and item names.
+
+#include "bench_util.h"
+#include "finescript/interner.h"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace finescript;
+
+namespace {
+
+/// The previous DefaultInterner, behind one mutex.
+class LockedInterner : public Interner {
+public:
+    uint32_t intern(std::string_view str) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(str);
+        if (it != index_.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(strings_.size());
+        strings_.emplace_back(str);
+        index_[std::string_view(strings_.back())] = id;
+        return id;
+    }
+    std::string_view lookup(uint32_t id) const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return strings_[id];
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<std::string> strings_;
+    std::unordered_map<std::string_view, uint32_t> index_;
+};
+
+constexpr int kNames = 2000;
+constexpr int kOpsPerThread = 200000;
+
+std::vector<std::string> makeNames() {
+    std::vector<std::string> names;
+    for (int i = 0; i < kNames; i++) names.push_back("symbol_" + std::to_string(i));
+    return names;
+}
+
+/// Each thread interns and looks up names; one in 64 operations is new.
+void run(Interner& interner, const std::vector<std::string>& names, int threads) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            size_t sink = 0;
+            for (int i = 0; i < kOpsPerThread; i++) {
+                if (i % 64 == 0) {
+                    interner.intern("fresh_" + std::to_string(t) + "_" + std::to_string(i));
+                    continue;
+                }
+                uint32_t id = interner.intern(names[(i * 31 + t) % kNames]);
+                sink += interner.lookup(id).size();
+            }
+            if (sink == 0) std::printf("unreachable\n");
+        });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+constexpr int kBigSymbols = 300000;
+
+std::vector<std::string> makeBigSymbols() {
+    std::vector<std::string> names;
+    for (int i = 0; i < kBigSymbols; i++) {
+        names.push_back("mod_" + std::to_string(i % 97) + ":block_" + std::to_string(i));
+    }
+    return names;
+}
+
+} // anonymous namespace
+
+int main() {
+    auto names = makeNames();
+    unsigned hw = std::max(2u, std::thread::hardware_concurrency());
+
+    std::printf("finescript: interner, %d ops per thread\n", kOpsPerThread);
+    for (unsigned threads : {1u, 2u, 4u, hw}) {
+        std::string label = std::to_string(threads) + " thread(s)";
+        std::printf("%s\n", label.c_str());
+        double locked = bench::measure("mutex + unordered_map", 1, [&] {
+            LockedInterner interner;
+            for (auto& name : names) interner.intern(name);
+            run(interner, names, static_cast<int>(threads));
+        }, 3);
+        double sharded = bench::measure("DefaultInterner", 1, [&] {
+            DefaultInterner interner;
+            for (auto& name : names) interner.intern(name);
+            run(interner, names, static_cast<int>(threads));
+        }, 3);
+        bench::compare(label, locked, sharded);
+        if (threads == hw) break;
+    }
+
+    auto big = makeBigSymbols();
+    std::vector<uint64_t> hashes;
+    for (auto& name : big) hashes.push_back(symbolHash(name));
+    std::printf("%d symbols\n", kBigSymbols);
+    double lockedFill = bench::measure("mutex + unordered_map: intern all", 1, [&] {
+        LockedInterner interner;
+        for (auto& name : big) interner.intern(name);
+    }, 3);
+    double fill = bench::measure("DefaultInterner: intern all", 1, [&] {
+        DefaultInterner interner;
+        for (auto& name : big) interner.intern(name);
+    }, 3);
+    bench::compare("intern all", lockedFill, fill);
+
+    DefaultInterner interner;
+    for (auto& name : big) interner.intern(name);
+    size_t sink = 0;
+    double rehash = bench::measure("DefaultInterner: hits", 1, [&] {
+        for (auto& name : big) sink += interner.intern(name);
+    }, 3);
+    double prehashed = bench::measure("DefaultInterner: hits, hash from the lexer", 1, [&] {
+        for (size_t i = 0; i < big.size(); i++) sink += interner.intern(big[i], hashes[i]);
+    }, 3);
+    bench::compare("hits", rehash, prehashed);
+    if (sink == 0) std::printf("unreachable\n");
+    return 0;
+}
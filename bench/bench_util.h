@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace finescript::bench {
+
+/// Run `body` `iterations` times per sample and report the best sample
+/// (least noisy on a shared machine) in nanoseconds per iteration.
+inline double measure(const std::string& label, int iterations,
+                      const std::function<void()>& body, int samples = 5) {
+    double best = 1e300;
+    body();  // warm-up
+    for (int s = 0; s < samples; s++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) body();
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        best = std::min(best, ns);
+    }
+    std::printf("  %-34s %12.0f ns/iter\n", label.c_str(), best);
+    return best;
+}
+
+/// Print a baseline/candidate pair with the speedup ratio.
+inline void compare(const std::string& name, double baseline, double candidate) {
+    std::printf("  %-34s %11.2fx\n", (name + " speedup").c_str(), baseline / candidate);
+}
+
+} // namespace finescript::bench
@@ -0,0 +1,123 @@
+// Tree-walk evaluator vs. bytecode compiler + register VM on typical
+// script workloads. The program is parsed (and compiled) once; each
+// iteration runs it in a fresh child scope of the global scope.
+
+#include "bench_util.h"
+#include "finescript/compiler.h"
+#include "finescript/evaluator.h"
+#include "finescript/interner.h"
+#include "finescript/parser.h"
+
+using namespace finescript;
+
+namespace {
+
+struct Workload {
+    const char* name;
+    const char* source;
+    int iterations;
+};
+
+const Workload kWorkloads[] = {
+    {"arithmetic loop", R"(
+set total 0
+for i in (0 .. 2000) do
+    set total (total + (i * 3) % 7)
+end
+total
+)", 200},
+    {"calls with early return", R"(
+fn clamp [x lo hi] do
+    if (x < lo) {return lo}
+    if (x > hi) {return hi}
+    x
+end
+set s 0
+for i in (0 .. 1000) do
+    set s (s + {clamp i 100 900})
+end
+s
+)", 200},
+    {"recursive fib 18", R"(
+fn fib [n] do
+    if (n <= 1) {return n}
+    ({fib (n - 1)} + {fib (n - 2)})
+end
+fib 18
+)", 10},
+    {"string building", R"(
+set s ""
+for i in (0 .. 300) do
+    set s "{s}{i},"
+end
+s.length
+)", 200},
+    {"report building", R"(
+set report ""
+for i in (0 .. 5000) do
+    set report (report + "row ")
+    set report "{report}{i};"
+end
+report.length
+)", 50},
+    {"map field access", R"(
+set p {=x 1 =y 2 =hp 100}
+set acc 0
+for i in (0 .. 1000) do
+    set p.x (p.x + 1)
+    set acc (acc + p.x + p.y)
+end
+acc
+)", 200},
+    {"built-in method calls", R"(
+set xs []
+set name "stone_bricks"
+set n 0
+for i in (0 .. 1000) do
+    xs.push i
+    set n (n + {xs.get i} + {name.find "_"} + xs.length)
+end
+n
+)", 200},
+    {"locals in a function", R"(
+fn steer [x y tx ty] do
+    let dx (tx - x)
+    let dy (ty - y)
+    set dist ((dx * dx) + (dy * dy))
+    for step in (0 .. 100) do
+        set x (x + dx / 8)
+        set y (y + dy / 8)
+    end
+    (x + y + dist)
+end
+set acc 0
+for i in (0 .. 20) do
+    set acc (acc + {steer i 0 100 50})
+end
+acc
+)", 200},
+};
+
+} // anonymous namespace
+
+int main() {
+    DefaultInterner interner;
+    auto globalScope = Scope::createGlobal();
+    Evaluator evaluator(interner, globalScope);
+
+    std::printf("finescript: tree walker vs register VM\n");
+    for (const auto& w : kWorkloads) {
+        auto ast = std::shared_ptr<AstNode>(Parser::parse(w.source).release());
+        auto chunk = Compiler::compile(ast, interner);
+
+        std::printf("%s\n", w.name);
+        double walk = bench::measure("eval (tree walker)", w.iterations, [&] {
+            evaluator.eval(ast, globalScope->createChild());
+        });
+        double vm = bench::measure("run (register VM)", w.iterations, [&] {
+            evaluator.run(*chunk, globalScope->createChild());
+        });
+        bench::compare(w.name, walk, vm);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "value.h"
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace finescript {
+
+/// Read-only view of a call's arguments (the C++17 stand-in for
+/// std::span<const Value>). The evaluator passes VM registers or an inline
+/// ArgBuffer this way, so a call never has to copy its arguments into a
+/// std::vector. Only valid for the duration of the call: copy out anything
+/// that must outlive it.
+class ArgSpan {
+public:
+    using value_type = Value;
+    using iterator = const Value*;
+
+    ArgSpan() = default;
+    ArgSpan(const Value* data, size_t size) : data_(data), size_(size) {}
+    ArgSpan(const std::vector<Value>& values) : data_(values.data()), size_(values.size()) {}
+    /// For call sites such as `fn.call(ctx, {a, b})`, where the list lives
+    /// until the call returns. Do not keep such a span in a variable: the
+    /// list dies at the end of the declaration (`ArgSpan a = {x, y};` dangles).
+    /// GCC warns about exactly that; the argument-passing use is intended.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winit-list-lifetime"
+#endif
+    ArgSpan(std::initializer_list<Value> values)
+        : data_(values.begin()), size_(values.size()) {}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    const Value* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const Value& operator[](size_t i) const { return data_[i]; }
+    const Value& front() const { return data_[0]; }
+    const Value& back() const { return data_[size_ - 1]; }
+    iterator begin() const { return data_; }
+    iterator end() const { return data_ + size_; }
+
+    /// The arguments from `offset` on.
+    ArgSpan subspan(size_t offset) const {
+        return offset < size_ ? ArgSpan(data_ + offset, size_ - offset) : ArgSpan();
+    }
+
+private:
+    const Value* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/// Argument list under construction. The first kInline arguments are stored
+/// in the buffer itself, so typical calls are assembled without touching the
+/// heap; longer lists spill to a std::vector.
+class ArgBuffer {
+public:
+    static constexpr size_t kInline = 6;
+
+    ArgBuffer() = default;
+    ArgBuffer(const ArgBuffer&) = delete;
+    ArgBuffer& operator=(const ArgBuffer&) = delete;
+
+    void push_back(Value value) {
+        if (size_ < kInline) {
+            inline_[size_++] = std::move(value);
+            return;
+        }
+        if (size_ == kInline) {
+            heap_.reserve(kInline * 2);
+            for (auto& v : inline_) heap_.push_back(std::move(v));
+        }
+        heap_.push_back(std::move(value));
+        size_++;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const Value* data() const { return size_ > kInline ? heap_.data() : inline_; }
+    Value& operator[](size_t i) { return size_ > kInline ? heap_[i] : inline_[i]; }
+
+    ArgSpan span() const { return ArgSpan(data(), size_); }
+    operator ArgSpan() const { return span(); }
+
+private:
+    Value inline_[kInline];
+    std::vector<Value> heap_;
+    size_t size_ = 0;
+};
+
+} // namespace finescript
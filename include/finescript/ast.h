@@ -1,13 +1,22 @@
 #pragma once
 
+#include "field_cache.h"
 #include "source_location.h"
+#include "value.h"
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace finescript {
 
+class Interner;
+
+/// Marks an unused symbol ID field (valid IDs start at 0).
+constexpr uint32_t kNoSymbol = std::numeric_limits<uint32_t>::max();
+
 enum class AstNodeKind {
     IntLit,
     FloatLit,
@@ -39,6 +48,22 @@ enum class AstNodeKind {
     MapLit,
 };
 
+/// Infix operators, resolved once by the parser so evaluation never
+/// compares operator strings.
+enum class BinaryOp : uint8_t {
+    None,
+    Add, Sub, Mul, Div, Mod,
+    Eq, Ne, Lt, Gt, Le, Ge,
+    Range, RangeIncl,
+    And, Or, NilCoalesce, FalsyCoalesce,
+};
+
+/// Map an operator spelling ("+", "..=", "and", "??", ...) to its enum.
+BinaryOp binaryOpFromString(std::string_view op);
+
+/// The source spelling of an operator (for error messages).
+const char* binaryOpName(BinaryOp op);
+
 struct AstNode {
     AstNodeKind kind;
     SourceLocation loc;
@@ -51,9 +76,35 @@ struct AstNode {
 
     std::vector<std::unique_ptr<AstNode>> children;
     std::string op;
+    BinaryOp binOp = BinaryOp::None;      // Infix: `op` as an enum
     std::vector<std::string> nameParts;
+
+    // Interned names, filled in by bindSymbols()
+    uint64_t nameHash = 0;                // Name/SymbolLit: symbolHash(stringValue) from
+                                          // the lexer, or 0 if not known
+    uint32_t symbolId = kNoSymbol;        // stringValue of Name/SymbolLit/Fn/On
+    std::vector<uint32_t> nameIds;        // parallel to nameParts
+    uint32_t restId = kNoSymbol;          // Fn: [rest] param (op = "rest|kwargs")
+    uint32_t kwargsId = kNoSymbol;        // Fn: {kwargs} param
+    std::vector<uint32_t> freeNames;      // Fn: names read or set by the body
+                                          // (nested fns included), minus params
+    const Interner* boundInterner = nullptr;  // root only: interner the IDs belong to
+    Value literal;                        // StringLit: stringValue as a shared string
+    bool selfAppend = false;              // Set: `set x (x + ...)` or `set x "{x}..."`,
+                                          // which may extend x's string in place
+
+    // DottedName/Set: inline cache per nameIds entry, filled by the evaluator
+    mutable std::vector<FieldCache> fieldCaches;
 };
 
+/// Intern every identifier in the tree (names, fields, map keys, named-arg
+/// keys, parameters) and store the IDs in the nodes, so evaluation never
+/// hashes a name. Also fills in each Fn's freeNames, which decide what a
+/// closure captures (Scope::capture), and builds each string literal's shared
+/// Value. Records `interner` on `root`; call again to rebind the tree if the
+/// interner changes.
+void bindSymbols(AstNode& root, Interner& interner);
+
 // Factory functions
 std::unique_ptr<AstNode> makeIntLit(int64_t val, SourceLocation loc);
 std::unique_ptr<AstNode> makeFloatLit(double val, SourceLocation loc);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "interner.h"
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace finescript {
+
+/// Symbols the engine itself dispatches on: built-in method names and the
+/// `self` parameter. The engine's own DefaultInterner reserves them first, so
+/// each one's ID is its enumerator value; with any other interner the
+/// evaluator maps IDs back to these through a small table.
+enum class BuiltinSymbol : uint32_t {
+    Get, Set, Has, Remove, Keys, Values, SetMethod,
+    Length, Push, Pop, Slice, Contains, Sort, SortBy, Map, Filter, Foreach,
+    CharAt, Insert, Delete, Replace, Find, Substr, Split,
+    Upper, Lower, Trim, StartsWith, EndsWith,
+    Self,
+    Count  // not a symbol
+};
+
+constexpr uint32_t kBuiltinSymbolCount = static_cast<uint32_t>(BuiltinSymbol::Count);
+
+/// Spellings, in BuiltinSymbol order.
+constexpr std::string_view kBuiltinSymbolNames[] = {
+    "get", "set", "has", "remove", "keys", "values", "setMethod",
+    "length", "push", "pop", "slice", "contains", "sort", "sort_by", "map", "filter", "foreach",
+    "char_at", "insert", "delete", "replace", "find", "substr", "split",
+    "upper", "lower", "trim", "starts_with", "ends_with",
+    "self",
+};
+static_assert(std::size(kBuiltinSymbolNames) == kBuiltinSymbolCount,
+              "kBuiltinSymbolNames must match BuiltinSymbol");
+
+constexpr StaticSymbols builtinSymbols() { return StaticSymbols(kBuiltinSymbolNames); }
+
+/// First ID free for a host's own static table when it follows the builtins
+/// in a DefaultInterner: DefaultInterner({builtinSymbols(), hostTable}).
+constexpr uint32_t kFirstHostSymbol = kBuiltinSymbolCount;
+
+} // namespace finescript
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "field_cache.h"
+#include "value.h"
+#include "scope.h"
+#include "source_location.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace finescript {
+
+struct AstNode;
+class Interner;
+
+/// Register VM opcodes. Unless noted, a/b/c are register indices into the
+/// current frame. "bx" is the 32-bit operand formed from b and c; "sym"
+/// operands are indices into Chunk::symbols.
+enum class OpCode : uint8_t {
+    LoadConst,    // R[a] = K[bx]
+    LoadInt,      // R[a] = int(int32 bx)
+    LoadString,   // R[a] = fresh copy of string K[bx] (strings are mutable)
+    LoadNil,      // R[a] = nil
+    LoadBool,     // R[a] = bool(b)
+    Move,         // R[a] = R[b]
+
+    GetName,      // R[a] = lookup(sym b), nil if unbound
+    GetNameStrict,// R[a] = lookup(sym b), error if unbound
+    SetName,      // scope.set(sym b, R[a])
+    DefineName,   // scope.define(sym b, R[a])
+
+    // Resolved names: slots of the current scope or of an enclosing one.
+    // An unbound slot (or a shadowing dynamic binding) falls back to the
+    // by-name path, so semantics match GetName/SetName exactly.
+    GetLocal,     // R[a] = slot b of this scope (sym c)
+    SetLocal,     // slot b of this scope = R[a] (sym c)
+    DefineLocal,  // bind slot b of this scope to R[a]
+    GetOuter,     // R[a] = slot described by outerRefs[b]
+    SetOuter,     // slot described by outerRefs[b] = R[a]
+
+    // Field operands index Chunk::fields, which carries each site's cache
+    GetField,     // R[a] = R[b].field(fields[c])  -- dotted-name semantics
+    GetMember,    // R[a] = R[b].get(fields[c])    -- R[b] must be a map
+    SetField,     // R[a].set(fields[c], R[b])     -- R[a] must be a map
+    Index,        // R[a] = R[b][R[c]]
+
+    Add, Sub, Mul, Div, Mod,      // R[a] = R[b] op R[c]
+    Append,       // R[a] = R[b] + R[c], then the next instruction stores R[a]
+                  // to the variable R[b] came from: `set s (s + x)`. A string
+                  // held only by R[b] and that variable grows in place.
+    Eq, Ne, Lt, Gt, Le, Ge,
+    Range, RangeIncl,
+    Not,          // R[a] = !R[b]
+    Negate,       // R[a] = -R[b]
+
+    Jump,         // pc = bx
+    JumpIfFalse,  // if !R[a].truthy() pc = bx
+    JumpIfTrue,   // if R[a].truthy() pc = bx
+    JumpIfNotNil, // if !R[a].isNil() pc = bx
+
+    NewArray,     // R[a] = [R[b] .. R[b+c-1]]
+    NewMap,       // R[a] = {}
+    MapSet,       // R[a].set(sym c, R[b]), marking self-methods
+    Concat,       // R[a] = str(R[b]) + .. + str(R[b+c-1])
+    AppendConcat, // R[a] = str(R[a]) + str(R[b]) + .. + str(R[b+c-1]), stored
+                  // like Append: `set s "{s}..."`
+
+    Call,         // R[a] = R[b](R[b+1] .. R[b+c])
+    CallNamed,    // R[a] = R[b](...) described by calls[c]
+    CallMethod,   // R[a] = R[b].path(...) described by calls[c]
+
+    MakeClosure,  // R[a] = closure over functions[bx]
+    OnHandler,    // register functions[bx] as an event handler; R[a] = nil
+
+    PushScope,    // enter a child scope laid out by scopeLayouts[bx]
+    PopScope,     // leave the innermost pushed scope
+    ForPrep,      // check R[a] is iterable; R[a+1] = cursor (Evaluator::forStep)
+    ForNext,      // R[a+2] = next element (map: key) of R[a]; when done pc = bx
+    ForNextPair,  // R[a+3] = next key or index, R[a+2] = its value; when done pc = bx
+
+    Source,       // R[a] = result of running script named R[b] in this scope
+    Return,       // return R[a]; c != 0 marks an explicit `return`
+};
+
+struct Instruction {
+    OpCode op;
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint16_t c = 0;
+
+    uint32_t bx() const { return static_cast<uint32_t>(b) | (static_cast<uint32_t>(c) << 16); }
+    void setBx(uint32_t v) {
+        b = static_cast<uint16_t>(v & 0xFFFF);
+        c = static_cast<uint16_t>(v >> 16);
+    }
+};
+
+/// Operand block for calls that need more than a register range:
+/// named arguments and method calls.
+struct CallSite {
+    uint16_t numPositional = 0;
+    std::vector<uint16_t> namedKeys;   // sym indices for =key arguments
+    std::vector<uint16_t> path;        // method calls: fields after the base
+    mutable std::vector<FieldCache> pathCaches;  // parallel to path
+};
+
+/// Operand block for a field access: the name plus the site's inline cache.
+struct FieldSite {
+    uint16_t sym = 0;                  // sym index
+    mutable FieldCache cache;
+};
+
+/// A name resolved to a slot `depth` scopes above the current one.
+struct OuterRef {
+    uint16_t depth = 0;
+    uint16_t slot = 0;
+    uint16_t sym = 0;    // sym index, for the by-name fallback
+};
+
+/// A compiled unit of code: a script body or a function body.
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<SourceLocation> locations;  // parallel to code
+    std::vector<Value> constants;
+    std::vector<uint32_t> symbols;          // interned symbol IDs
+    std::vector<CallSite> calls;
+    std::vector<FieldSite> fields;
+    std::vector<std::shared_ptr<const Chunk>> functions; // nested fn/on bodies
+    std::vector<OuterRef> outerRefs;
+    std::shared_ptr<const ScopeLayout> layout;  // call scope slots; null for scripts
+    std::vector<std::shared_ptr<const ScopeLayout>> scopeLayouts; // `for` scopes
+
+    uint16_t numRegisters = 0;
+    const AstNode* node = nullptr;   // Fn/On node for function chunks
+    std::shared_ptr<const AstNode> astRoot;  // keeps the AST alive
+    const Interner* interner = nullptr;      // symbol IDs are only valid for this
+    std::string name;
+};
+
+/// Render a chunk as human-readable text (for debugging and tests).
+std::string disassemble(const Chunk& chunk);
+
+/// Register storage for VM frames. Frames are carved out of fixed-size
+/// segments so that a frame's registers never move while nested calls
+/// push further frames.
+class RegisterStack {
+public:
+    RegisterStack() = default;
+    RegisterStack(const RegisterStack&) = delete;
+    RegisterStack& operator=(const RegisterStack&) = delete;
+
+    /// Reserve `count` contiguous nil registers.
+    Value* push(size_t count);
+
+    /// Release the most recently pushed frame (resets its registers to nil).
+    void pop(Value* base, size_t count);
+
+private:
+    static constexpr size_t kSegmentSize = 4096;
+
+    struct Segment {
+        std::unique_ptr<Value[]> regs;
+        size_t capacity = 0;
+        size_t top = 0;
+    };
+    std::vector<Segment> segments_;
+    size_t current_ = 0;
+};
+
+} // namespace finescript
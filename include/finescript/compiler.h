@@ -0,0 +1,23 @@
+#pragma once
+
+#include "bytecode.h"
+#include <memory>
+#include <string>
+
+namespace finescript {
+
+struct AstNode;
+class Interner;
+
+class Compiler {
+public:
+    /// Compile a program (typically the Block returned by Parser::parse)
+    /// into a chunk for the register VM. Symbol IDs come from `interner`
+    /// (the tree is bound to it first if needed), so the chunk may only be
+    /// run by evaluators sharing it.
+    static std::shared_ptr<const Chunk> compile(std::shared_ptr<AstNode> root,
+                                                Interner& interner,
+                                                std::string name = "<script>");
+};
+
+} // namespace finescript
@@ -30,8 +30,10 @@ struct ScriptResult {
     // returnValue is stored separately since Value isn't defined here
 };
 
-/// Non-local jump signal for `return`. NOT derived from std::exception
-/// to avoid accidental catch in generic error handlers.
+/// Carrier for a returned value. NOT derived from std::exception to avoid
+/// accidental catch in generic error handlers. The evaluator and VM no
+/// longer throw it (`return` is a completion status); it is kept for
+/// source compatibility with host code.
 class ReturnSignal {
 public:
     // Default constructor needed because Value isn't complete here.
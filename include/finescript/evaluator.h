@@ -1,9 +1,16 @@
 #pragma once
 
 #include "value.h"
+#include "ast.h"
 #include "scope.h"
+#include "bytecode.h"
+#include "arg_span.h"
+#include "builtin_symbols.h"
+#include "method_table.h"
 #include "source_location.h"
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace finescript {
 
@@ -17,6 +24,8 @@ public:
     Evaluator(Interner& interner, std::shared_ptr<Scope> globalScope,
               ScriptEngine* engine = nullptr);
 
+    /// Evaluate a node as a program. A `return` outside any function ends
+    /// it and yields the returned value.
     Value eval(const AstNode& node, std::shared_ptr<Scope> scope,
                ExecutionContext* ctx = nullptr);
 
@@ -25,79 +34,165 @@ public:
     Value eval(std::shared_ptr<AstNode> root, std::shared_ptr<Scope> scope,
                ExecutionContext* ctx = nullptr);
 
+    /// Compile a program to bytecode and run it on the register VM.
+    /// Produces the same result as eval() on the same root.
+    Value execute(std::shared_ptr<AstNode> root, std::shared_ptr<Scope> scope,
+                  ExecutionContext* ctx = nullptr);
+
+    /// Run a compiled chunk in the given scope.
+    Value run(const Chunk& chunk, std::shared_ptr<Scope> scope,
+              ExecutionContext* ctx = nullptr);
+
     /// Call a closure or native function with the given arguments.
-    Value callFunction(const Value& callable, std::vector<Value> args,
+    Value callFunction(const Value& callable, ArgSpan args,
                        std::shared_ptr<Scope> scope, ExecutionContext* ctx,
                        SourceLocation callSite);
 
+    /// Add or replace the method `sym` on every value of `type`, so scripts
+    /// can call `value.name args...`. On maps it takes precedence over a field
+    /// of the same name, like the built-in map methods. A callable value gets
+    /// the receiver as its first argument.
+    void setMethod(Value::Type type, uint32_t sym, MethodFn fn);
+    void setMethod(Value::Type type, uint32_t sym, Value function);
+
 private:
     Interner& interner_;
     std::shared_ptr<Scope> globalScope_;
     ScriptEngine* engine_;
     std::shared_ptr<const AstNode> currentAstRoot_;
-
-    // Pre-interned common symbols for fast dispatch
-    uint32_t sym_get_, sym_set_, sym_has_, sym_remove_, sym_keys_;
-    uint32_t sym_values_, sym_length_, sym_push_, sym_pop_;
-    uint32_t sym_setMethod_, sym_slice_, sym_contains_, sym_sort_;
-    uint32_t sym_map_, sym_filter_, sym_foreach_;
-    // String method symbols
-    uint32_t sym_insert_, sym_delete_, sym_replace_, sym_split_;
-    uint32_t sym_substr_, sym_find_, sym_upper_, sym_lower_, sym_trim_;
-    uint32_t sym_starts_with_, sym_ends_with_, sym_char_at_;
-    uint32_t sym_sort_by_;
-    uint32_t sym_self_;
+    RegisterStack registers_;
+
+    /// How the tree walker leaves a node. `return` records Completion::Return
+    /// and its value instead of throwing; every evaluator that runs further
+    /// sub-expressions checks unwinding() and stops, and the enclosing call
+    /// (or the program) consumes it via takeReturn(). Loops are where
+    /// break/continue completions would be consumed.
+    enum class Completion : uint8_t { Normal, Return };
+    Completion completion_ = Completion::Normal;
+    Value completionValue_;
+
+    bool unwinding() const { return completion_ != Completion::Normal; }
+    Value takeReturn(Value result);
+
+    // IDs of the BuiltinSymbol names in interner_. With the engine's own
+    // interner they equal the enumerators (builtinIdsFixed_) and mapping an ID
+    // back is a range check; otherwise it is a search of builtinsById_.
+    uint32_t builtinIds_[kBuiltinSymbolCount];
+    bool builtinIdsFixed_ = false;
+    std::vector<std::pair<uint32_t, BuiltinSymbol>> builtinsById_;  // sorted by ID
+
+    uint32_t builtinId(BuiltinSymbol symbol) const {
+        return builtinIds_[static_cast<uint32_t>(symbol)];
+    }
+    /// The BuiltinSymbol an interned ID stands for, or BuiltinSymbol::Count.
+    BuiltinSymbol builtinSymbol(uint32_t id) const {
+        if (builtinIdsFixed_) {
+            return id < kBuiltinSymbolCount ? static_cast<BuiltinSymbol>(id) : BuiltinSymbol::Count;
+        }
+        return lookupBuiltinSymbol(id);
+    }
+    BuiltinSymbol lookupBuiltinSymbol(uint32_t id) const;
 
     void preInternSymbols();
 
     /// Check if a value is a closure whose first parameter is named "self".
     bool isAutoMethod(const Value& val) const;
 
+    Value evalNode(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    /// `result = evalNode(...)`, releasing the old result first. Blocks and
+    /// loops would otherwise hold the previous statement's value while the
+    /// next one runs, and a held string cannot grow in place (evalSelfAppend).
+    void evalInto(Value& result, const AstNode& node, Scope& scope, ExecutionContext* ctx) {
+        result = Value();
+        result = evalNode(node, scope, ctx);
+    }
     Value evalIntLit(const AstNode& node);
     Value evalFloatLit(const AstNode& node);
     Value evalStringLit(const AstNode& node);
-    Value evalStringInterp(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
+    /// Evaluate a value that is only read, never kept or mutated (operator
+    /// operands, interpolation parts, match patterns): string literals come
+    /// back as their shared AST value instead of a fresh copy.
+    Value evalOperand(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalStringInterp(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    /// Format the parts of a StringInterp node from `first` on.
+    std::string interpolate(const AstNode& node, size_t first, Scope& scope, ExecutionContext* ctx);
     Value evalSymbolLit(const AstNode& node);
     Value evalBoolLit(const AstNode& node);
     Value evalNilLit(const AstNode& node);
-    Value evalArrayLit(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalName(const AstNode& node, std::shared_ptr<Scope> scope);
-    Value evalDottedName(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalCall(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalInfix(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalUnaryNot(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalUnaryNegate(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalBlock(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalIndex(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalRef(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalMapLit(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-
-    Value evalSet(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalLet(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalFn(const AstNode& node, std::shared_ptr<Scope> scope);
-    Value evalIf(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalFor(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalWhile(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalMatch(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalOn(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalReturn(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-    Value evalSource(const AstNode& node, std::shared_ptr<Scope> scope, ExecutionContext* ctx);
-
-    Value callClosure(Closure& closure, std::vector<Value> args,
+    Value evalArrayLit(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalName(const AstNode& node, Scope& scope);
+    Value evalDottedName(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalCall(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalInfix(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalUnaryNot(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalUnaryNegate(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalBlock(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalIndex(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalRef(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalMapLit(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+
+    Value evalSet(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalSelfAppend(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalLet(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalFn(const AstNode& node, Scope& scope);
+    Value evalIf(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalFor(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalWhile(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalMatch(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalOn(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalReturn(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+    Value evalSource(const AstNode& node, Scope& scope, ExecutionContext* ctx);
+
+    /// Build a closure for a Fn node (params, defaults, variadics) capturing
+    /// what its body uses from `scope` (see Scope::capture).
+    std::shared_ptr<Closure> makeClosure(const AstNode& node, Scope& scope);
+
+    /// Call a closure or native function (callFunction without the unused scope).
+    Value invoke(const Value& callable, ArgSpan args,
+                 ExecutionContext* ctx, SourceLocation callSite);
+
+    /// One step of dotted-name access (`obj.field`), including the
+    /// built-in properties keys/values/length/pop.
+    Value getField(const Value& object, uint32_t sym, SourceLocation loc,
+                   FieldCache* cache = nullptr);
+
+    /// Subscript access (`a[i]`) on arrays, strings, and maps.
+    Value indexValue(const Value& target, const Value& index, SourceLocation loc);
+
+    /// One step of a `for` loop over a string, array, range or regular map
+    /// (`cursor` starts at 0). Sets `value`, and `key` if non-null: the map
+    /// key, else the index (for a string, the byte offset of the UTF-8
+    /// character in `value`). Without `key` a map yields its keys. Returns
+    /// false when done. Proxy maps are walked with ProxyMap::iterate().
+    bool forStep(const Value& iterable, size_t& cursor, Value& value, Value* key);
+
+    // -- Register VM (vm.cpp) --
+    /// Run a chunk; `returned` is set when it finished via an explicit `return`.
+    Value runFrame(const Chunk& chunk, std::shared_ptr<Scope> scope,
+                   ExecutionContext* ctx, bool& returned);
+    Value callMethod(const Value& base, const Chunk& chunk, const CallSite& site,
+                     const Value* args, ExecutionContext* ctx, SourceLocation loc);
+    Value callNamed(const Value& callee, const Chunk& chunk, const CallSite& site,
+                    const Value* args, ExecutionContext* ctx, SourceLocation loc);
+
+    Value callClosure(Closure& closure, ArgSpan args,
                       ExecutionContext* ctx, SourceLocation callSite);
-    Value callClosureWithNamed(Closure& closure, std::vector<Value> posArgs,
+    Value callClosureWithNamed(Closure& closure, ArgSpan posArgs,
                                std::vector<std::pair<uint32_t, Value>> namedArgs,
                                ExecutionContext* ctx, SourceLocation callSite);
 
-    // Built-in map/array method dispatch
-    Value dispatchBuiltinMethod(const Value& object, uint32_t methodSymbol,
-                                std::vector<Value> args, std::shared_ptr<Scope> scope,
-                                ExecutionContext* ctx, SourceLocation loc);
-    bool isBuiltinMapMethod(uint32_t sym) const;
-    bool isBuiltinArrayMethod(uint32_t sym) const;
-    bool isBuiltinStringMethod(uint32_t sym) const;
+    // Methods on value types: `receiver.name args...` looks in the table of
+    // the receiver's type first (before map fields), one indexed load.
+    static constexpr size_t kValueTypeCount = static_cast<size_t>(Value::Type::NativeFunction) + 1;
+    MethodTable methods_[kValueTypeCount];
+
+    /// Fill methods_ with the built-in map, array and string methods.
+    void initMethodTables();
+    const Method* findMethod(const Value& receiver, uint32_t sym) const;
+    Value invokeMethod(const Method& method, const Value& self, ArgSpan args,
+                       ExecutionContext* ctx, SourceLocation loc);
 
-    Value applyBinOp(const std::string& op, const Value& left, const Value& right,
+    Value applyBinOp(BinaryOp op, const Value& left, const Value& right,
                      SourceLocation loc);
 };
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace finescript {
+
+class Shape;
+
+/// Inline cache for one field-access site (a dotted name, a method call or a
+/// field store). Remembers where the field lives in maps of one shape, so
+/// repeated accesses from the same site on maps laid out alike skip the
+/// key search entirely (MapData::lookup).
+struct FieldCache {
+    static constexpr uint32_t kAbsent = ~uint32_t(0);
+
+    const Shape* shape = nullptr;  // nullptr never matches a map
+    uint32_t index = kAbsent;      // value slot, or kAbsent if the key is missing
+    bool method = false;           // entry is marked as a method
+};
+
+} // namespace finescript
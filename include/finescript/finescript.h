@@ -3,6 +3,7 @@
 // Umbrella header for finescript
 #include "value.h"
 #include "interner.h"
+#include "builtin_symbols.h"
 #include "source_location.h"
 #include "error.h"
 #include "native_function.h"
@@ -13,6 +14,7 @@
 #include "ast.h"
 #include "parser.h"
 #include "scope.h"
+#include "method_table.h"
 #include "evaluator.h"
 #include "execution_context.h"
 #include "script_engine.h"
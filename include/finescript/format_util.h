@@ -1,6 +1,7 @@
 #pragma once
 
 #include "value.h"
+#include "arg_span.h"
 #include "source_location.h"
 #include <string>
 #include <vector>
@@ -51,7 +52,7 @@ inline std::string formatOneValue(const std::string& spec, const Value& val, Int
 
 // Format a string with multiple specifiers and multiple values.
 // %% produces a literal %. Each other %... specifier consumes one arg.
-inline std::string formatMulti(const std::string& fmt, const std::vector<Value>& args,
+inline std::string formatMulti(const std::string& fmt, ArgSpan args,
                                Interner* interner) {
     std::string result;
     size_t argIdx = 0;
@@ -1,13 +1,50 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
-#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 
 namespace finescript {
 
+/// The hash intern(str, hash) takes: 64-bit FNV-1a. It goes a byte at a
+/// time, so the lexer computes it with symbolHashStep() while it scans an
+/// identifier and the interner never reads the bytes a second time.
+constexpr uint64_t kSymbolHashSeed = 0xcbf29ce484222325ull;
+
+constexpr uint64_t symbolHashStep(uint64_t hash, char c) {
+    return (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+}
+
+constexpr uint64_t symbolHash(std::string_view str) {
+    uint64_t hash = kSymbolHashSeed;
+    for (char c : str) hash = symbolHashStep(hash, c);
+    return hash;
+}
+
+/// A vocabulary fixed at compile time: an array of spellings whose IDs are
+/// known in advance. A DefaultInterner constructed with tables interns them
+/// first and in order, so entry i of the first table gets ID i, entry i of
+/// the second gets ID (first table's size) + i, and so on.
+///
+///     constexpr std::string_view kBlockNames[] = {"air", "stone", "dirt"};
+///     enum BlockSymbol : uint32_t { Air = kFirstHostSymbol, Stone, Dirt };
+///     DefaultInterner interner({builtinSymbols(), StaticSymbols(kBlockNames)});
+struct StaticSymbols {
+    template <size_t N>
+    constexpr explicit StaticSymbols(const std::string_view (&names)[N])
+        : names(names), count(N) {}
+    constexpr StaticSymbols(const std::string_view* names, size_t count)
+        : names(names), count(count) {}
+
+    const std::string_view* names;
+    size_t count;
+};
+
 /// Abstract string interner interface. finescript ships with DefaultInterner.
 /// Host applications can provide their own by subclassing this.
 class Interner {
@@ -17,20 +54,91 @@ public:
     /// Intern a string, returning a unique ID. Same string -> same ID.
     virtual uint32_t intern(std::string_view str) = 0;
 
+    /// Intern a string whose symbolHash() is already known. Interners that
+    /// hash differently can keep this default, which ignores `hash`.
+    virtual uint32_t intern(std::string_view str, uint64_t hash) {
+        (void)hash;
+        return intern(str);
+    }
+
     /// Look up the string for an interned ID.
     virtual std::string_view lookup(uint32_t id) const = 0;
 };
 
-/// Built-in interner using deque for stable string storage.
+/// Built-in interner, safe to share between threads (scripts parsed or run
+/// on worker threads see the same symbol IDs as the main thread).
+///
+/// lookup() is wait-free and intern() of a known string is lock-free: both
+/// only read tables that are never changed in place. A new string takes the
+/// lock of one of kShards shards, plus a short global lock that hands out
+/// IDs, which stay dense and in insertion order.
+///
+/// The text of all strings lives in a few large chunks rather than one
+/// allocation per string, and each table slot caches half the hash, so a
+/// probe only compares bytes when the hash already matches.
 class DefaultInterner : public Interner {
 public:
+    DefaultInterner();
+    /// Start with the given tables reserved (see StaticSymbols). Throws
+    /// std::invalid_argument if a spelling repeats, which would break the
+    /// ID arithmetic.
+    explicit DefaultInterner(std::initializer_list<StaticSymbols> tables);
+    ~DefaultInterner() override;
+    DefaultInterner(const DefaultInterner&) = delete;
+    DefaultInterner& operator=(const DefaultInterner&) = delete;
+
     uint32_t intern(std::string_view str) override;
+    uint32_t intern(std::string_view str, uint64_t hash) override;
     std::string_view lookup(uint32_t id) const override;
 
+    /// Number of strings interned so far.
+    uint32_t size() const { return count_.load(std::memory_order_acquire); }
+
 private:
-    // deque doesn't invalidate pointers on growth, so string_view keys stay valid
-    std::deque<std::string> strings_;
-    std::unordered_map<std::string_view, uint32_t> index_;
+    static constexpr size_t kShards = 16;
+    static constexpr size_t kFirstSegment = 256;    // IDs in segment 0; each next doubles
+    static constexpr size_t kSegments = 25;         // enough for every uint32_t ID
+    static constexpr size_t kChunkSize = 64 * 1024; // bytes of string text per chunk
+
+    /// One shard's open-addressing table. A slot holds the high half of the
+    /// string's hash over id + 1 (0 = empty). Slots are only ever filled, so
+    /// readers probe without a lock; a table that gets too full is replaced
+    /// by a bigger copy, and the old one stays readable until destruction.
+    struct Table {
+        explicit Table(size_t capacity);
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    struct Shard {
+        Shard();
+        std::mutex mutex;
+        std::atomic<Table*> table;
+        size_t count = 0;                               // guarded by mutex
+        std::vector<std::unique_ptr<Table>> tables;     // current and retired, guarded by mutex
+    };
+
+    /// ID + 1 of `str` in `table`, or 0.
+    uint32_t find(const Table& table, uint64_t hash, std::string_view str) const;
+    /// Store a new string and return its ID.
+    uint32_t append(std::string_view str);
+    /// Copy `str` into the chunks (appendMutex_ held).
+    std::string_view store(std::string_view str);
+    std::string_view entry(uint32_t id) const;
+
+    Shard shards_[kShards];
+
+    // String storage: `chunks_` own the text (never moved or freed before
+    // destruction) and the segments, published once allocated, index it by
+    // ID. A string longer than a quarter chunk gets a chunk of its own.
+    // `segmentOwners_` own what `segments_` publish to lock-free readers.
+    std::mutex appendMutex_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* chunkPos_ = nullptr;
+    size_t chunkLeft_ = 0;
+    std::unique_ptr<std::string_view[]> segmentOwners_[kSegments];
+    std::atomic<std::string_view*> segments_[kSegments] = {};
+    std::atomic<uint32_t> count_{0};
 };
 
 } // namespace finescript
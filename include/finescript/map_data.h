@@ -1,6 +1,9 @@
 #pragma once
 
+#include "field_cache.h"
 #include "proxy_map.h"
+#include "value.h"
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <unordered_map>
@@ -9,24 +12,114 @@
 
 namespace finescript {
 
-class Value;
+/// Hidden class of a map: its keys in slot order plus which of them are
+/// methods. Maps built with the same keys in the same order share one shape
+/// and keep only a dense value array, so a dozen widget or entity maps with
+/// the same fields pay for the key set once. Shapes form a process-wide
+/// transition tree rooted at empty(); they are immutable once built and
+/// never freed, so a Shape* can safely identify a layout in a FieldCache.
+class Shape {
+public:
+    /// Maps with more keys than this switch to dictionary mode.
+    static constexpr size_t kMaxKeys = 32;
+
+    static const Shape* empty();
+
+    const std::vector<uint32_t>& keys() const { return keys_; }
+    size_t size() const { return keys_.size(); }
+
+    /// Slot of `key`, or -1.
+    int indexOf(uint32_t key) const {
+        for (size_t i = 0; i < keys_.size(); i++) {
+            if (keys_[i] == key) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    bool isMethod(size_t index) const { return (methods_ >> index) & 1u; }
+
+    /// This shape plus `key` in a new last slot, or nullptr if the map
+    /// should become a dictionary instead (too many keys, or the process-wide
+    /// shape budget is spent).
+    const Shape* withKey(uint32_t key) const;
+
+    /// This shape with slot `index` marked as a method.
+    const Shape* withMethod(size_t index) const;
+
+private:
+    struct TransitionTable;
+
+    Shape() = default;
+    const Shape* transition(uint64_t edge, uint32_t methods) const;
+
+    std::vector<uint32_t> keys_;
+    uint32_t methods_ = 0;   // bit i: keys_[i] is a method
+    // Children by edge (key, or key | kMethodEdge). Lookups read the
+    // published table without locking; adding a child takes a global mutex.
+    mutable std::atomic<TransitionTable*> transitions_{nullptr};
+};
 
-/// Unified map storage -- either a regular hash map or a proxy map.
+/// Unified map storage -- either a regular map or a proxy map.
 /// The evaluator uses this without checking which kind it is.
 /// Method flags are always stored locally (even for proxy maps).
-class MapData {
+///
+/// A regular map starts in shape mode (a shared Shape plus a value per
+/// slot) and drops to dictionary mode, a private ordered table, once it is
+/// used like one: a key is removed, it outgrows Shape::kMaxKeys, or a method
+/// mark names a missing key. Either way keys, values and forEach visit
+/// entries in insertion order, so iteration is deterministic across runs
+/// and machines (proxy maps use the proxy's own order).
+class MapData : public RefCounted {
 public:
     /// Create an empty regular map.
     MapData() = default;
 
     /// Create a proxy-backed map.
-    explicit MapData(std::shared_ptr<ProxyMap> proxy) : proxy_(std::move(proxy)) {}
+    explicit MapData(std::shared_ptr<ProxyMap> proxy)
+        : proxy_(std::move(proxy)), shape_(nullptr), dict_(std::make_unique<Dict>()) {}
+
+    MapData(const MapData& other)
+        : RefCounted(other), proxy_(other.proxy_), shape_(other.shape_),
+          values_(other.values_),
+          dict_(other.dict_ ? std::make_unique<Dict>(*other.dict_) : nullptr) {}
+    MapData& operator=(const MapData& other) {
+        proxy_ = other.proxy_;
+        shape_ = other.shape_;
+        values_ = other.values_;
+        dict_ = other.dict_ ? std::make_unique<Dict>(*other.dict_) : nullptr;
+        return *this;
+    }
 
     Value get(uint32_t key) const;
     void set(uint32_t key, Value value);
     bool has(uint32_t key) const;
     bool remove(uint32_t key);
     std::vector<uint32_t> keys() const;
+    std::vector<Value> values() const;
+    size_t size() const;
+
+    /// Step a `for` loop over a regular map: fill in the first entry at or
+    /// after position `cursor` and move the cursor past it, or return false
+    /// at the end. Entries added during the loop are visited; those removed
+    /// before the cursor reaches them are not. The cursor counts insertions,
+    /// not positions, so it stays valid when removals compact the map.
+    /// Proxy maps use iterate().
+    bool nextEntry(size_t& cursor, uint32_t& key, Value& value) const;
+
+    /// Visit each (key, value) in order without looking keys up again.
+    template <class F>
+    void forEach(F&& visit) const {
+        if (proxy_) {
+            for (uint32_t key : proxy_->keys()) visit(key, proxy_->get(key));
+        } else if (shape_) {
+            const auto& keys = shape_->keys();
+            for (size_t i = 0; i < keys.size(); i++) visit(keys[i], values_[i]);
+        } else {
+            for (const auto& entry : dict_->entries) {
+                if (entry.live) visit(entry.key, entry.value);
+            }
+        }
+    }
 
     /// Store a value and mark the key as a method (auto-passes self on dot-call).
     void setMethod(uint32_t key, Value funcValue);
@@ -38,11 +131,72 @@ public:
     bool isMethod(uint32_t key) const;
 
     bool isProxy() const { return proxy_ != nullptr; }
+    ProxyMap* proxy() const { return proxy_.get(); }
+
+    /// The map's shape, or nullptr for proxy and dictionary-mode maps.
+    const Shape* shape() const { return shape_; }
+
+    /// has + get + isMethod in one step for an access site that owns
+    /// `cache`: returns false if `key` is absent, else copies the value to
+    /// `out` and sets `method`. Once the cache has seen a shape, lookups on
+    /// any map of that shape skip the key search. Dictionary and proxy maps
+    /// are never cached.
+    bool lookup(uint32_t key, FieldCache& cache, Value& out, bool& method) const {
+        if (!shape_ || cache.shape != shape_) return lookupSlow(key, cache, out, method);
+        if (cache.index == FieldCache::kAbsent) return false;
+        out = values_[cache.index];
+        method = cache.method;
+        return true;
+    }
+
+    /// get() through an access site's cache.
+    Value get(uint32_t key, FieldCache& cache) const {
+        Value out;
+        bool method;
+        lookup(key, cache, out, method);
+        return out;
+    }
+
+    /// set() through an access site's cache.
+    void set(uint32_t key, Value value, FieldCache& cache) {
+        if (shape_ && cache.shape == shape_ && cache.index != FieldCache::kAbsent) {
+            values_[cache.index] = std::move(value);
+            return;
+        }
+        set(key, std::move(value));
+    }
 
 private:
+    /// Dictionary mode: entries in insertion order plus a key index. A
+    /// removed entry stays in place, dead, until dead ones outnumber live.
+    /// Each entry keeps its insertion number, which is its position until
+    /// the first compaction and is what nextEntry() cursors refer to.
+    struct Dict {
+        struct Entry {
+            uint32_t key;
+            bool live;
+            size_t seq;
+            Value value;
+        };
+        std::vector<Entry> entries;
+        std::unordered_map<uint32_t, uint32_t> index;   // key -> entries position
+        size_t dead = 0;
+        size_t nextSeq = 0;                             // == entries.size() until compacted
+        std::unordered_set<uint32_t> methodKeys;
+
+        Value* find(uint32_t key);
+        void set(uint32_t key, Value value);
+        bool remove(uint32_t key);
+    };
+
+    bool lookupSlow(uint32_t key, FieldCache& cache, Value& out, bool& method) const;
+    /// Move the entries into a private hash table (shape mode -> dictionary).
+    void toDictionary();
+
     std::shared_ptr<ProxyMap> proxy_;
-    std::unordered_map<uint32_t, Value> entries_;
-    std::unordered_set<uint32_t> methodKeys_;
+    const Shape* shape_ = Shape::empty();   // nullptr: proxy or dictionary mode
+    std::vector<Value> values_;             // shape mode: one per shape_ slot
+    std::unique_ptr<Dict> dict_;            // proxy (method keys only) or dictionary mode
 };
 
 } // namespace finescript
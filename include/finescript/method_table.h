@@ -0,0 +1,57 @@
+#pragma once
+
+#include "value.h"
+#include "arg_span.h"
+#include "source_location.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace finescript {
+
+class Evaluator;
+class ExecutionContext;
+
+/// A method implemented in C++. `self` is the receiver and `args` are the
+/// positional arguments after it (valid only during the call).
+using MethodFn = Value (*)(Evaluator& ev, const Value& self, ArgSpan args,
+                           ExecutionContext* ctx, SourceLocation loc);
+
+/// A method on a value type: a C++ function, or a callable value (native
+/// function or closure) that receives the receiver as its first argument.
+struct Method {
+    MethodFn fn = nullptr;
+    Value function;
+
+    bool defined() const { return fn || !function.isNil(); }
+};
+
+/// The methods of one value type, keyed by interned name. Symbol IDs are
+/// dense, so IDs below kDenseLimit (the builtins, with the engine's own
+/// interner) index a vector directly; larger ones fall back to a hash map.
+class MethodTable {
+public:
+    static constexpr uint32_t kDenseLimit = 1024;
+
+    const Method* find(uint32_t sym) const {
+        if (sym < dense_.size()) return dense_[sym].defined() ? &dense_[sym] : nullptr;
+        if (sparse_.empty()) return nullptr;
+        auto it = sparse_.find(sym);
+        return it == sparse_.end() ? nullptr : &it->second;
+    }
+
+    void set(uint32_t sym, Method method) {
+        if (sym >= kDenseLimit) {
+            sparse_[sym] = std::move(method);
+            return;
+        }
+        if (sym >= dense_.size()) dense_.resize(sym + 1);
+        dense_[sym] = std::move(method);
+    }
+
+private:
+    std::vector<Method> dense_;
+    std::unordered_map<uint32_t, Method> sparse_;
+};
+
+} // namespace finescript
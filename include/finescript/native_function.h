@@ -1,30 +1,30 @@
 #pragma once
 
+#include "arg_span.h"
 #include <functional>
 #include <memory>
-#include <vector>
 
 namespace finescript {
 
-class Value;
 class ExecutionContext;
 
 /// A native function object -- a C++ object with state and a callable method.
 /// From the script's perspective, it looks like a regular function.
-class NativeFunctionObject {
+class NativeFunctionObject : public RefCounted {
 public:
     virtual ~NativeFunctionObject() = default;
-    virtual Value call(ExecutionContext& ctx, const std::vector<Value>& args) = 0;
+    /// `args` views the caller's argument storage and is only valid during the call.
+    virtual Value call(ExecutionContext& ctx, ArgSpan args) = 0;
 };
 
 /// Convenience: wrap a std::function as a NativeFunctionObject.
 class SimpleLambdaFunction : public NativeFunctionObject {
 public:
-    using Func = std::function<Value(ExecutionContext&, const std::vector<Value>&)>;
+    using Func = std::function<Value(ExecutionContext&, ArgSpan)>;
 
     explicit SimpleLambdaFunction(Func fn) : fn_(std::move(fn)) {}
 
-    Value call(ExecutionContext& ctx, const std::vector<Value>& args) override {
+    Value call(ExecutionContext& ctx, ArgSpan args) override {
         return fn_(ctx, args);
     }
 
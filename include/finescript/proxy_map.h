@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace finescript {
@@ -19,6 +20,18 @@ public:
     virtual bool has(uint32_t key) const = 0;
     virtual bool remove(uint32_t key) = 0;
     virtual std::vector<uint32_t> keys() const = 0;
+
+    /// Cursor over a proxy's entries, used by `for` loops.
+    class Iterator {
+    public:
+        virtual ~Iterator() = default;
+        /// Fill in the next entry, or return false when done.
+        virtual bool next(uint32_t& key, Value& value) = 0;
+    };
+
+    /// Walk the entries. The default snapshots keys() and calls get() per
+    /// key; override it when the backing store can be walked directly.
+    virtual std::unique_ptr<Iterator> iterate() const;
 };
 
 } // namespace finescript
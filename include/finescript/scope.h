@@ -7,11 +7,49 @@
 
 namespace finescript {
 
+/// Names a compiled function or loop body binds, in slot order. Every scope
+/// created for that body shares the layout and stores those names in a flat
+/// slot array instead of the bindings map.
+struct ScopeLayout {
+    std::vector<uint32_t> names;
+};
+
+class FramePool;
+
+/// A variable scope. Every scope descended from one createGlobal() call is
+/// allocated from that tree's FramePool: the scope, its shared_ptr control
+/// block and its slot array come from recycled blocks, so entering a call or
+/// loop does not reach the global allocator in steady state. A scope captured
+/// by a closure simply keeps its block until the closure lets go. Like the
+/// rest of the engine, a scope tree must only be used from one thread at a
+/// time.
+///
+/// Call and loop scopes are *frames* (createFrame). A closure created inside
+/// a frame does not keep the frame chain alive: capture() gives it a copy of
+/// the frames holding only the variables its body uses, each shared with the
+/// original through a cell, so the closure and the frame see each other's
+/// updates while every other local dies with its frame.
 class Scope : public std::enable_shared_from_this<Scope> {
 public:
     static std::shared_ptr<Scope> createGlobal();
     std::shared_ptr<Scope> createChild();
 
+    /// Child scope with one (initially unbound) slot per name in `layout`.
+    std::shared_ptr<Scope> createChild(std::shared_ptr<const ScopeLayout> layout);
+
+    /// Child scope for one call or loop body (see capture()).
+    std::shared_ptr<Scope> createFrame(std::shared_ptr<const ScopeLayout> layout = nullptr);
+
+    /// The scope a closure created here should capture, given the names its
+    /// body reads or sets (AstNode::freeNames). Outside a frame that is this
+    /// scope. Inside one it is a copy of the enclosing frames, up to the first
+    /// non-frame scope, sharing just those names; copies keep each frame's
+    /// layout so compiled depth/slot references still line up. A name not
+    /// bound yet gets an unbound placeholder in every frame, so a later set
+    /// or define (e.g. of a recursive helper) is seen whichever frame it
+    /// lands in.
+    std::shared_ptr<Scope> capture(const std::vector<uint32_t>& names);
+
     /// Lookup: walks the scope chain upward. Returns pointer if found, nullptr if not.
     Value* lookup(uint32_t symbolId);
 
@@ -24,12 +62,98 @@ public:
 
     bool hasLocal(uint32_t symbolId) const;
     std::vector<uint32_t> localKeys() const;
-    std::shared_ptr<Scope> parent() const { return parent_; }
+    const std::shared_ptr<Scope>& parent() const { return parent_; }
+
+    // -- Slot access (compiled code; indices come from the layout) --
+
+    /// Slot value, or nullptr while the slot is unbound.
+    Value* slot(size_t index) { return slots_[index].get(); }
+    void bindSlot(size_t index, Value value) { slots_[index].put(std::move(value)); }
+
+    /// True if this scope holds names outside its layout (from `source`,
+    /// `global`, a `set` that created a new variable, or a capture
+    /// placeholder). Such a name can shadow a slot that the compiler resolved
+    /// in an outer scope.
+    bool hasDynamicBindings() const { return numInline_ != 0; }
+
+    /// Constructor access for the factories above (allocate_shared needs a
+    /// public constructor).
+    class Key {
+        friend class Scope;
+        Key() = default;
+    };
+    Scope(Key, FramePool* pool, std::shared_ptr<Scope> parent,
+          std::shared_ptr<const ScopeLayout> layout);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
 
 private:
-    explicit Scope(std::shared_ptr<Scope> parent);
+    struct Cell {
+        Value value;
+        bool bound = false;
+    };
+
+    /// A captured variable, owned jointly by its frame and the frame copies
+    /// of the closures that captured it.
+    struct SharedCell : Cell {
+        uint32_t refs = 1;
+    };
+
+    /// Storage for one slot or binding. Holds its value in place until a
+    /// closure captures it; from then on the value lives in `shared`.
+    struct Slot {
+        Cell local;
+        SharedCell* shared = nullptr;
+
+        Slot() = default;
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+        ~Slot() {
+            if (shared && --shared->refs == 0) delete shared;
+        }
+
+        Cell& cell() { return shared ? *shared : local; }
+        const Cell& cell() const { return shared ? *shared : local; }
+        Value* get() {
+            Cell& c = cell();
+            return c.bound ? &c.value : nullptr;
+        }
+        void put(Value value) {
+            Cell& c = cell();
+            c.value = std::move(value);
+            c.bound = true;
+        }
+        /// Move the value into a shared cell (once) and return it.
+        SharedCell* share();
+    };
+
+    /// Index of `symbolId` in the layout, or -1.
+    int slotIndex(uint32_t symbolId) const;
+    /// The slot or binding for `symbolId`, bound or not.
+    Slot* findEntry(uint32_t symbolId);
+    Slot& addBinding(uint32_t symbolId);
+    Value* findLocal(uint32_t symbolId);
+
+    FramePool* pool_;   // kept alive by this scope's own block
     std::shared_ptr<Scope> parent_;
-    std::unordered_map<uint32_t, Value> bindings_;
+    std::shared_ptr<const ScopeLayout> layout_;
+    Slot* slots_ = nullptr;   // layout_->names.size() slots from pool_
+    bool frame_ = false;
+
+    // Names outside the layout. The first kInlineBindings live in the scope
+    // itself and are found by linear search, so loop and call scopes never
+    // allocate for them; further names go to a hash table. Entries never
+    // move once bound, so Value pointers from lookup() stay valid.
+    static constexpr size_t kInlineBindings = 4;
+    struct Binding {
+        uint32_t symbol = 0;
+        Slot entry;
+    };
+    Binding inline_[kInlineBindings];
+    size_t numInline_ = 0;
+    std::unique_ptr<std::unordered_map<uint32_t, Slot>> overflow_;
 };
 
 } // namespace finescript
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "value.h"
+#include "arg_span.h"
 #include "error.h"
 #include <filesystem>
 #include <functional>
@@ -15,9 +16,12 @@ class Scope;
 class ExecutionContext;
 class ResourceFinder;
 
+struct Chunk;
+
 struct CompiledScript {
     std::shared_ptr<AstNode> root;
     std::string name;
+    mutable std::shared_ptr<const Chunk> chunk;  // bytecode, compiled on first execute
 };
 
 /// Extended script result that includes the return value.
@@ -35,6 +39,13 @@ public:
     ScriptEngine();
     ~ScriptEngine();
 
+    /// Make the calling thread the engine's owner. Scripts run on one thread
+    /// at a time; when built with FINESCRIPT_ATOMIC_REFCOUNT=0, execute() and
+    /// callFunction() throw std::logic_error on any other thread. Call this
+    /// after handing the whole engine (and every value it holds) over, with
+    /// the previous thread no longer touching it.
+    void bindToCurrentThread();
+
     // Parsing
     CompiledScript* loadScript(const std::filesystem::path& path);
     std::unique_ptr<CompiledScript> parseString(std::string_view source,
@@ -46,16 +57,28 @@ public:
     FullScriptResult execute(const CompiledScript& script, ExecutionContext& context);
     FullScriptResult executeCommand(std::string_view command, ExecutionContext& context);
 
+    /// Bytecode for a script, compiled on first use and cached on the script.
+    /// Recompiled if the engine's interner has changed since.
+    std::shared_ptr<const Chunk> bytecode(const CompiledScript& script);
+
     /// Call a script closure or native function from C++.
     /// Returns the function's return value, or throws on error.
-    Value callFunction(const Value& callable, std::vector<Value> args,
+    Value callFunction(const Value& callable, ArgSpan args,
                        ExecutionContext& context);
 
     // Registration
     void registerFunction(std::string_view name,
-                          std::function<Value(ExecutionContext&, const std::vector<Value>&)> func);
+                          std::function<Value(ExecutionContext&, ArgSpan)> func);
     void registerConstant(std::string_view name, Value value);
 
+    /// Add a native method to every value of `type`, callable from scripts as
+    /// `value.name args...`. `func` gets the receiver as args[0], followed by
+    /// the positional arguments (named arguments are not passed). It goes in
+    /// the same per-type table as the built-in methods, replacing a built-in
+    /// of the same name, and on maps it takes precedence over fields.
+    void registerMethod(Value::Type type, std::string_view name,
+                        std::function<Value(ExecutionContext&, ArgSpan)> func);
+
     // Resource finder
     void setResourceFinder(ResourceFinder* finder);
     std::filesystem::path resolveScript(std::string_view name);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "value.h"
+
+namespace finescript {
+
+/// Moves a script value to another thread.
+///
+/// Values share heap objects through reference counts, and with
+/// FINESCRIPT_ATOMIC_REFCOUNT off those counts are plain integers: two
+/// threads must never hold references to the same object. A ThreadHandoff
+/// deep-copies its value into objects nothing else references (preserving
+/// sharing and cycles within the value), so the copy can be passed to another
+/// thread through any synchronized channel and take()n there exactly once.
+///
+/// Only data can be handed off: strings, arrays, ranges, plain maps and
+/// scalars. Closures, native functions and proxy maps refer to state that
+/// stays behind, so the constructor throws std::runtime_error for them.
+class ThreadHandoff {
+public:
+    explicit ThreadHandoff(const Value& value);
+
+    ThreadHandoff(ThreadHandoff&&) = default;
+    ThreadHandoff& operator=(ThreadHandoff&&) = default;
+    ThreadHandoff(const ThreadHandoff&) = delete;
+    ThreadHandoff& operator=(const ThreadHandoff&) = delete;
+
+    /// The copied value, on the receiving thread. Throws std::logic_error if
+    /// it was already taken.
+    Value take();
+
+private:
+    Value value_;
+    bool taken_ = false;
+};
+
+} // namespace finescript
@@ -83,6 +83,7 @@ struct Token {
     SourceLocation location;
     int64_t intValue = 0;
     double floatValue = 0.0;
+    uint64_t hash = 0;      // Name, SymbolLiteral, KeyName: symbolHash(text)
     bool hasLeadingSpace = false;
 };
 
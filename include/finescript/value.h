@@ -2,24 +2,93 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <variant>
+#include <string_view>
+#include <atomic>
 #include <vector>
 
+// Reference counts on script values are atomic by default, so values may be
+// copied and dropped from several threads like shared_ptr. Build with
+// FINESCRIPT_ATOMIC_REFCOUNT=0 (CMake option FINESCRIPT_ATOMIC_REFCOUNT=OFF)
+// when every value stays on the script thread; values then cross threads
+// only through a ThreadHandoff (thread_handoff.h).
+#ifndef FINESCRIPT_ATOMIC_REFCOUNT
+#define FINESCRIPT_ATOMIC_REFCOUNT 1
+#endif
+
 namespace finescript {
 
 // Forward declarations
 class MapData;
 class Interner;
 class NativeFunctionObject;
+class Value;
+struct RangeData;
+
+/// Intrusive reference count carried by every heap object a Value can point
+/// at (strings, arrays, ranges, maps, closures, native functions). Copying a
+/// Value bumps this count in place instead of a separate shared_ptr control
+/// block.
+///
+/// Objects handed in as a std::shared_ptr (Value::map(ptr), Value::closure(ptr),
+/// ...) stay owned by that shared_ptr: while any Value refers to the object it
+/// keeps a copy in `owner_`, so host-held and script-held references share one
+/// object. mapPtr() and friends create `owner_` on demand for objects the
+/// Value allocated itself.
+class RefCounted {
+public:
+    RefCounted() = default;
+    RefCounted(const RefCounted&) {}             // a copy starts unreferenced
+    RefCounted& operator=(const RefCounted&) { return *this; }
+
+    /// Number of Values (and ThreadHandoffs) referring to this object.
+    uint32_t refCount() const {
+#if FINESCRIPT_ATOMIC_REFCOUNT
+        return refs_.load(std::memory_order_relaxed);
+#else
+        return refs_;
+#endif
+    }
+
+protected:
+    ~RefCounted() = default;
+
+private:
+    friend class Value;
+
+    void retain() const {
+#if FINESCRIPT_ATOMIC_REFCOUNT
+        refs_.fetch_add(1, std::memory_order_relaxed);
+#else
+        ++refs_;
+#endif
+    }
+    /// Drop a reference; true if it was the last one.
+    bool releaseLast() const {
+#if FINESCRIPT_ATOMIC_REFCOUNT
+        return refs_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#else
+        return --refs_ == 0;
+#endif
+    }
+
+#if FINESCRIPT_ATOMIC_REFCOUNT
+    mutable std::atomic<uint32_t> refs_{0};
+#else
+    mutable uint32_t refs_ = 0;
+#endif
+    std::shared_ptr<void> owner_;
+};
 
 /// Script closure (function + captured scope).
-struct Closure {
+struct Closure : RefCounted {
     std::vector<uint32_t> paramIds;           // interned parameter names
     size_t numRequired = 0;                   // number of required params (without defaults)
     std::vector<const struct AstNode*> defaultExprs; // defaults for params[numRequired..]
     const struct AstNode* body = nullptr;     // raw pointer into AST
     std::shared_ptr<const struct AstNode> astRoot; // keeps AST alive
+    std::shared_ptr<const struct Chunk> chunk;     // compiled body, null if tree-walked
     std::shared_ptr<class Scope> capturedScope;
     std::string name;                         // empty if anonymous
     // Variadic params
@@ -29,7 +98,9 @@ struct Closure {
     bool hasKwargsParam = false;
 };
 
-/// The universal value type in finescript.
+/// The universal value type in finescript: a 16-byte tagged union. Nil,
+/// bool, int, float and symbol are stored inline, so copying them is a plain
+/// register move; every other type points at a RefCounted heap object.
 class Value {
 public:
     enum class Type : std::size_t {
@@ -46,7 +117,32 @@ public:
     };
 
     /// Default constructs nil.
-    Value() : data_(std::monostate{}) {}
+    Value() : p_{}, tag_(kNil) {}
+
+    Value(const Value& other) : p_(other.p_), tag_(other.tag_) {
+        if (onHeap()) p_.obj->retain();
+    }
+    Value(Value&& other) noexcept : p_(other.p_), tag_(other.tag_) {
+        other.tag_ = kNil;
+    }
+    Value& operator=(const Value& other) {
+        Value copy(other);
+        swap(copy);
+        return *this;
+    }
+    Value& operator=(Value&& other) noexcept {
+        Value moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+    ~Value() {
+        if (onHeap()) release();
+    }
+
+    void swap(Value& other) noexcept {
+        std::swap(p_, other.p_);
+        std::swap(tag_, other.tag_);
+    }
 
     // -- Static factories --
     static Value nil();
@@ -55,9 +151,18 @@ public:
     static Value number(double d);
     static Value symbol(uint32_t id);
     static Value string(std::string s);
+    /// Copies the string: the value does not share it with the host.
+    [[deprecated("copies; use Value::string(std::string) and stringPtr()")]]
     static Value string(std::shared_ptr<std::string> s);
+    /// A read-only string that many values may share, such as a literal's
+    /// text. Mutating it through asStringMut() first gives that value its own
+    /// copy (copy-on-write), so the sharers never see each other's changes.
+    static Value sharedString(std::string s);
     static Value array(std::vector<Value> elems);
+    /// Copies the elements: the value does not share them with the host.
+    [[deprecated("copies; use Value::array(std::vector<Value>) and arrayPtr()")]]
     static Value array(std::shared_ptr<std::vector<Value>> a);
+    static Value range(int64_t start, int64_t end);  // [start, end), reports as an array
     static Value map();
     static Value map(std::shared_ptr<MapData> data);
     static Value proxyMap(std::shared_ptr<class ProxyMap> proxy);
@@ -65,28 +170,45 @@ public:
     static Value nativeFunction(std::shared_ptr<NativeFunctionObject> f);
 
     // -- Type queries --
-    Type type() const { return static_cast<Type>(data_.index()); }
-    bool isNil() const { return type() == Type::Nil; }
-    bool isBool() const { return type() == Type::Bool; }
-    bool isInt() const { return type() == Type::Int; }
-    bool isFloat() const { return type() == Type::Float; }
+    // Lazy ranges report Type::Array; use lazyRange() to take the fast path.
+    Type type() const {
+        return tag_ == kRange ? Type::Array : static_cast<Type>(tag_);
+    }
+    bool isNil() const { return tag_ == kNil; }
+    bool isBool() const { return is(Type::Bool); }
+    bool isInt() const { return is(Type::Int); }
+    bool isFloat() const { return is(Type::Float); }
     bool isNumeric() const { return isInt() || isFloat(); }
-    bool isString() const { return type() == Type::String; }
-    bool isSymbol() const { return type() == Type::Symbol; }
-    bool isArray() const { return type() == Type::Array; }
-    bool isMap() const { return type() == Type::Map; }
-    bool isClosure() const { return type() == Type::Closure; }
-    bool isNativeFunction() const { return type() == Type::NativeFunction; }
+    bool isString() const { return is(Type::String); }
+    bool isSymbol() const { return is(Type::Symbol); }
+    bool isArray() const { return is(Type::Array) || tag_ == kRange; }
+    bool isMap() const { return is(Type::Map); }
+    bool isClosure() const { return is(Type::Closure); }
+    bool isNativeFunction() const { return is(Type::NativeFunction); }
     bool isCallable() const { return isClosure() || isNativeFunction(); }
 
-    // -- Accessors (throw ScriptError on type mismatch) --
-    bool asBool() const;
-    int64_t asInt() const;
-    double asFloat() const;
-    double asNumber() const;  // works for int or float
-    uint32_t asSymbol() const;
+    /// The range bounds if this is a range that has not been materialized
+    /// yet, otherwise null.
+    inline const RangeData* lazyRange() const;
+
+    // -- Accessors (throw on type mismatch) --
+    // The array accessors materialize lazy ranges.
+    bool asBool() const { return isBool() ? p_.b : (typeMismatch("a bool"), false); }
+    int64_t asInt() const { return isInt() ? p_.i : (typeMismatch("an int"), 0); }
+    double asFloat() const { return isFloat() ? p_.d : (typeMismatch("a float"), 0.0); }
+    double asNumber() const {  // works for int or float
+        if (isInt()) return static_cast<double>(p_.i);
+        return isFloat() ? p_.d : (typeMismatch("numeric"), 0.0);
+    }
+    uint32_t asSymbol() const { return isSymbol() ? p_.sym : (typeMismatch("a symbol"), 0u); }
     const std::string& asString() const;
     std::string& asStringMut();
+    /// Append to this string in place, for `set s (s + x)`. `held` is the
+    /// caller's copy of this value (the left operand). Succeeds, releasing
+    /// `held`, only if the two are the string's sole holders: no alias, host
+    /// pointer or sharer could see the change. Otherwise returns false and
+    /// changes nothing, and the caller builds a new string.
+    bool appendInPlace(Value& held, std::string_view suffix);
     const std::vector<Value>& asArray() const;
     std::vector<Value>& asArrayMut();
     MapData& asMap();
@@ -95,13 +217,14 @@ public:
     const finescript::Closure& asClosure() const;
     NativeFunctionObject& asNativeFunction();
 
-    // -- Shared pointer access (for reference sharing) --
-    std::shared_ptr<std::string>& stringPtr();
-    std::shared_ptr<std::vector<Value>>& arrayPtr();
-    std::shared_ptr<MapData>& mapPtr();
+    // -- Shared pointer access (for reference sharing with host code) --
+    // The returned pointer shares ownership with this value's heap object.
+    std::shared_ptr<std::string> stringPtr();
+    std::shared_ptr<std::vector<Value>> arrayPtr();
+    std::shared_ptr<MapData> mapPtr();
 
     // -- Truthiness: nil and false are falsy, everything else truthy --
-    bool truthy() const;
+    bool truthy() const { return tag_ == kBool ? p_.b : tag_ != kNil; }
 
     // -- Equality --
     bool operator==(const Value& other) const;
@@ -112,19 +235,66 @@ public:
     std::string typeName() const;
 
 private:
-    using Variant = std::variant<
-        std::monostate,                              // Nil
-        bool,                                        // Bool
-        int64_t,                                     // Int
-        double,                                      // Float
-        uint32_t,                                    // Symbol
-        std::shared_ptr<std::string>,                // String
-        std::shared_ptr<std::vector<Value>>,         // Array
-        std::shared_ptr<MapData>,                    // Map
-        std::shared_ptr<finescript::Closure>,         // Closure
-        std::shared_ptr<NativeFunctionObject>        // NativeFunction
-    >;
-    Variant data_;
+    // tag_ holds a Type, or kRange for a lazy range (which reports as an
+    // array). Every tag from String on refers to a heap object in p_.obj.
+    static constexpr uint8_t kNil = static_cast<uint8_t>(Type::Nil);
+    static constexpr uint8_t kBool = static_cast<uint8_t>(Type::Bool);
+    static constexpr uint8_t kFirstHeap = static_cast<uint8_t>(Type::String);
+    static constexpr uint8_t kRange = static_cast<uint8_t>(Type::NativeFunction) + 1;
+
+    union Payload {
+        bool b;
+        int64_t i;
+        double d;
+        uint32_t sym;
+        RefCounted* obj;
+    };
+    Payload p_;
+    uint8_t tag_;
+
+    bool is(Type t) const { return tag_ == static_cast<uint8_t>(t); }
+    bool onHeap() const { return tag_ >= kFirstHeap; }
+
+    /// Point this (nil) value at a heap object, taking a reference.
+    void adopt(uint8_t tag, RefCounted* obj) {
+        obj->retain();
+        p_.obj = obj;
+        tag_ = tag;
+    }
+    /// Adopt an object owned by a shared_ptr (see RefCounted).
+    void adoptShared(uint8_t tag, RefCounted* obj, std::shared_ptr<void> owner);
+    void release() {
+        if (p_.obj->releaseLast()) destroy();
+    }
+    void destroy();
+    /// The object's shared_ptr owner, created on first use.
+    const std::shared_ptr<void>& sharedOwner() const;
+
+    [[noreturn]] void typeMismatch(const char* expected) const;
 };
 
+static_assert(sizeof(Value) == 16, "Value should be a 16-byte tagged union");
+
+/// Lazy integer range produced by `a .. b` and `a ..= b`: start, start+1,
+/// ..., end-1. Length, indexing and iteration read the bounds directly; the
+/// first caller that needs a real std::vector materializes `elements`, after
+/// which every copy of the value shares that array. Materializing runs once
+/// even when copies on several threads ask at the same time; `ready`
+/// publishes the finished array to readers that skip the once_flag.
+struct RangeData : RefCounted {
+    int64_t start = 0;
+    int64_t end = 0;                                // exclusive
+    Value elements;                                 // array once materialized
+    std::once_flag once;
+    std::atomic<bool> ready{false};                 // elements is set
+
+    int64_t size() const { return end > start ? end - start : 0; }
+};
+
+inline const RangeData* Value::lazyRange() const {
+    if (tag_ != kRange) return nullptr;
+    auto* range = static_cast<const RangeData*>(p_.obj);
+    return range->ready.load(std::memory_order_acquire) ? nullptr : range;
+}
+
 } // namespace finescript
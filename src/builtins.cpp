@@ -23,14 +23,14 @@ static std::mt19937& rng() {
 // ---- Math builtins ----
 
 void registerMathBuiltins(ScriptEngine& engine) {
-    engine.registerFunction("abs", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("abs", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         if (args[0].isInt()) return Value::integer(std::abs(args[0].asInt()));
         if (args[0].isFloat()) return Value::number(std::abs(args[0].asFloat()));
         return Value::nil();
     });
 
-    engine.registerFunction("min", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("min", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return args.empty() ? Value::nil() : args[0];
         bool anyFloat = args[0].isFloat() || args[1].isFloat();
         if (anyFloat) {
@@ -39,7 +39,7 @@ void registerMathBuiltins(ScriptEngine& engine) {
         return Value::integer(std::min(args[0].asInt(), args[1].asInt()));
     });
 
-    engine.registerFunction("max", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("max", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return args.empty() ? Value::nil() : args[0];
         bool anyFloat = args[0].isFloat() || args[1].isFloat();
         if (anyFloat) {
@@ -48,30 +48,30 @@ void registerMathBuiltins(ScriptEngine& engine) {
         return Value::integer(std::max(args[0].asInt(), args[1].asInt()));
     });
 
-    engine.registerFunction("floor", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("floor", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         if (args[0].isInt()) return args[0];
         return Value::integer(static_cast<int64_t>(std::floor(args[0].asNumber())));
     });
 
-    engine.registerFunction("ceil", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("ceil", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         if (args[0].isInt()) return args[0];
         return Value::integer(static_cast<int64_t>(std::ceil(args[0].asNumber())));
     });
 
-    engine.registerFunction("round", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("round", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         if (args[0].isInt()) return args[0];
         return Value::integer(static_cast<int64_t>(std::round(args[0].asNumber())));
     });
 
-    engine.registerFunction("sqrt", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("sqrt", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         return Value::number(std::sqrt(args[0].asNumber()));
     });
 
-    engine.registerFunction("pow", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("pow", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::nil();
         bool anyFloat = args[0].isFloat() || args[1].isFloat();
         double result = std::pow(args[0].asNumber(), args[1].asNumber());
@@ -83,26 +83,26 @@ void registerMathBuiltins(ScriptEngine& engine) {
         return Value::number(result);
     });
 
-    engine.registerFunction("sin", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("sin", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         return Value::number(std::sin(args[0].asNumber()));
     });
 
-    engine.registerFunction("cos", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("cos", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         return Value::number(std::cos(args[0].asNumber()));
     });
 
-    engine.registerFunction("tan", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("tan", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         return Value::number(std::tan(args[0].asNumber()));
     });
 
-    engine.registerFunction("random", [](ExecutionContext&, const std::vector<Value>&) -> Value {
+    engine.registerFunction("random", [](ExecutionContext&, ArgSpan) -> Value {
         return Value::integer(static_cast<int64_t>(rng()()));
     });
 
-    engine.registerFunction("random_range", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("random_range", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::nil();
         int64_t lo = args[0].asInt();
         int64_t hi = args[1].asInt();
@@ -110,7 +110,7 @@ void registerMathBuiltins(ScriptEngine& engine) {
         return Value::integer(dist(rng()));
     });
 
-    engine.registerFunction("random_float", [](ExecutionContext&, const std::vector<Value>&) -> Value {
+    engine.registerFunction("random_float", [](ExecutionContext&, ArgSpan) -> Value {
         std::uniform_real_distribution<double> dist(0.0, 1.0);
         return Value::number(dist(rng()));
     });
@@ -119,32 +119,32 @@ void registerMathBuiltins(ScriptEngine& engine) {
 // ---- Comparison builtins ----
 
 void registerComparisonBuiltins(ScriptEngine& engine) {
-    engine.registerFunction("eq", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("eq", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::boolean(false);
         return Value::boolean(args[0] == args[1]);
     });
 
-    engine.registerFunction("ne", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("ne", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::boolean(true);
         return Value::boolean(args[0] != args[1]);
     });
 
-    engine.registerFunction("lt", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("lt", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::boolean(false);
         return Value::boolean(args[0].asNumber() < args[1].asNumber());
     });
 
-    engine.registerFunction("gt", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("gt", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::boolean(false);
         return Value::boolean(args[0].asNumber() > args[1].asNumber());
     });
 
-    engine.registerFunction("le", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("le", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::boolean(false);
         return Value::boolean(args[0].asNumber() <= args[1].asNumber());
     });
 
-    engine.registerFunction("ge", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("ge", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2) return Value::boolean(false);
         return Value::boolean(args[0].asNumber() >= args[1].asNumber());
     });
@@ -153,12 +153,12 @@ void registerComparisonBuiltins(ScriptEngine& engine) {
 // ---- String builtins ----
 
 void registerStringBuiltins(ScriptEngine& engine) {
-    engine.registerFunction("str_length", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("str_length", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty() || !args[0].isString()) return Value::integer(0);
         return Value::integer(static_cast<int64_t>(args[0].asString().size()));
     });
 
-    engine.registerFunction("str_concat", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("str_concat", [](ExecutionContext&, ArgSpan args) -> Value {
         std::string result;
         for (auto& a : args) {
             result += a.toString();
@@ -166,7 +166,7 @@ void registerStringBuiltins(ScriptEngine& engine) {
         return Value::string(std::move(result));
     });
 
-    engine.registerFunction("str_substr", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("str_substr", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2 || !args[0].isString()) return Value::nil();
         const auto& s = args[0].asString();
         auto start = static_cast<size_t>(args[1].asInt());
@@ -178,21 +178,21 @@ void registerStringBuiltins(ScriptEngine& engine) {
         return Value::string(std::string(s.substr(start)));
     });
 
-    engine.registerFunction("str_find", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("str_find", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.size() < 2 || !args[0].isString() || !args[1].isString()) return Value::integer(-1);
         auto pos = args[0].asString().find(args[1].asString());
         if (pos == std::string::npos) return Value::integer(-1);
         return Value::integer(static_cast<int64_t>(pos));
     });
 
-    engine.registerFunction("str_upper", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("str_upper", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty() || !args[0].isString()) return Value::nil();
         std::string result = args[0].asString();
         for (auto& c : result) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
         return Value::string(std::move(result));
     });
 
-    engine.registerFunction("str_lower", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("str_lower", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty() || !args[0].isString()) return Value::nil();
         std::string result = args[0].asString();
         for (auto& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
@@ -200,18 +200,17 @@ void registerStringBuiltins(ScriptEngine& engine) {
     });
 
     // format "fmt" arg1 arg2 ... — multi-arg printf-style formatting
-    engine.registerFunction("format", [](ExecutionContext& ctx, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("format", [](ExecutionContext& ctx, ArgSpan args) -> Value {
         if (args.empty() || !args[0].isString()) return Value::nil();
         const auto& fmt = args[0].asString();
-        std::vector<Value> fmtArgs(args.begin() + 1, args.end());
-        return Value::string(formatMulti(fmt, fmtArgs, &ctx.engine().interner()));
+        return Value::string(formatMulti(fmt, args.subspan(1), &ctx.engine().interner()));
     });
 }
 
 // ---- Type conversion builtins ----
 
 void registerTypeBuiltins(ScriptEngine& engine) {
-    engine.registerFunction("to_int", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("to_int", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         auto& v = args[0];
         if (v.isInt()) return v;
@@ -224,7 +223,7 @@ void registerTypeBuiltins(ScriptEngine& engine) {
         return Value::nil();
     });
 
-    engine.registerFunction("to_float", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("to_float", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::nil();
         auto& v = args[0];
         if (v.isFloat()) return v;
@@ -237,17 +236,17 @@ void registerTypeBuiltins(ScriptEngine& engine) {
         return Value::nil();
     });
 
-    engine.registerFunction("to_str", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("to_str", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::string("");
         return Value::string(args[0].toString());
     });
 
-    engine.registerFunction("to_bool", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("to_bool", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::boolean(false);
         return Value::boolean(args[0].truthy());
     });
 
-    engine.registerFunction("type", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("type", [](ExecutionContext&, ArgSpan args) -> Value {
         if (args.empty()) return Value::string("nil");
         return Value::string(args[0].typeName());
     });
@@ -256,7 +255,7 @@ void registerTypeBuiltins(ScriptEngine& engine) {
 // ---- I/O builtins ----
 
 void registerIOBuiltins(ScriptEngine& engine) {
-    engine.registerFunction("print", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("print", [](ExecutionContext&, ArgSpan args) -> Value {
         for (size_t i = 0; i < args.size(); ++i) {
             if (i > 0) std::cout << ' ';
             std::cout << args[i].toString();
@@ -269,16 +268,16 @@ void registerIOBuiltins(ScriptEngine& engine) {
 // ---- Map constructor ----
 
 static void registerMapConstructor(ScriptEngine& engine) {
-    engine.registerFunction("map", [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+    engine.registerFunction("map", [](ExecutionContext&, ArgSpan args) -> Value {
         auto mapData = std::make_shared<MapData>();
         // Positional pairs: :key1 val1 :key2 val2 ...
         size_t end = args.size();
         // If last arg is a map (kwargs from named args), pull its entries
         if (!args.empty() && args.back().isMap()) {
             auto& kwargsMap = const_cast<Value&>(args.back()).asMap();
-            for (auto key : kwargsMap.keys()) {
-                mapData->set(key, kwargsMap.get(key));
-            }
+            kwargsMap.forEach([&](uint32_t key, const Value& value) {
+                mapData->set(key, value);
+            });
             end--;  // don't process kwargs map as positional pair
         }
         for (size_t i = 0; i + 1 < end; i += 2) {
@@ -0,0 +1,127 @@
+#include "finescript/bytecode.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace finescript {
+
+// -- RegisterStack --
+
+Value* RegisterStack::push(size_t count) {
+    if (segments_.empty()) {
+        segments_.push_back({});
+    }
+    while (true) {
+        Segment& seg = segments_[current_];
+        if (seg.capacity == 0) {
+            // Start small so short-lived evaluators stay cheap; grow per segment
+            size_t cap = std::min(kSegmentSize, size_t(256) << current_);
+            seg.capacity = std::max(cap, count);
+            seg.regs = std::make_unique<Value[]>(seg.capacity);
+        }
+        if (seg.top + count <= seg.capacity) {
+            Value* base = seg.regs.get() + seg.top;
+            seg.top += count;
+            return base;
+        }
+        // Doesn't fit: continue in the next segment (segments past current_ are empty)
+        current_++;
+        if (current_ == segments_.size()) {
+            segments_.push_back({});
+        } else if (segments_[current_].capacity < count) {
+            segments_[current_] = {};
+        }
+    }
+}
+
+void RegisterStack::pop(Value* base, size_t count) {
+    Segment& seg = segments_[current_];
+    for (size_t i = 0; i < count; i++) {
+        base[i] = Value();
+    }
+    seg.top -= count;
+    if (seg.top == 0 && current_ > 0) {
+        current_--;
+    }
+}
+
+// -- Disassembler --
+
+static const char* opCodeName(OpCode op) {
+    switch (op) {
+        case OpCode::LoadConst:     return "LoadConst";
+        case OpCode::LoadInt:       return "LoadInt";
+        case OpCode::LoadString:    return "LoadString";
+        case OpCode::LoadNil:       return "LoadNil";
+        case OpCode::LoadBool:      return "LoadBool";
+        case OpCode::Move:          return "Move";
+        case OpCode::GetName:       return "GetName";
+        case OpCode::GetNameStrict: return "GetNameStrict";
+        case OpCode::SetName:       return "SetName";
+        case OpCode::DefineName:    return "DefineName";
+        case OpCode::GetLocal:      return "GetLocal";
+        case OpCode::SetLocal:      return "SetLocal";
+        case OpCode::DefineLocal:   return "DefineLocal";
+        case OpCode::GetOuter:      return "GetOuter";
+        case OpCode::SetOuter:      return "SetOuter";
+        case OpCode::GetField:      return "GetField";
+        case OpCode::GetMember:     return "GetMember";
+        case OpCode::SetField:      return "SetField";
+        case OpCode::Index:         return "Index";
+        case OpCode::Add:           return "Add";
+        case OpCode::Append:        return "Append";
+        case OpCode::Sub:           return "Sub";
+        case OpCode::Mul:           return "Mul";
+        case OpCode::Div:           return "Div";
+        case OpCode::Mod:           return "Mod";
+        case OpCode::Eq:            return "Eq";
+        case OpCode::Ne:            return "Ne";
+        case OpCode::Lt:            return "Lt";
+        case OpCode::Gt:            return "Gt";
+        case OpCode::Le:            return "Le";
+        case OpCode::Ge:            return "Ge";
+        case OpCode::Range:         return "Range";
+        case OpCode::RangeIncl:     return "RangeIncl";
+        case OpCode::Not:           return "Not";
+        case OpCode::Negate:        return "Negate";
+        case OpCode::Jump:          return "Jump";
+        case OpCode::JumpIfFalse:   return "JumpIfFalse";
+        case OpCode::JumpIfTrue:    return "JumpIfTrue";
+        case OpCode::JumpIfNotNil:  return "JumpIfNotNil";
+        case OpCode::NewArray:      return "NewArray";
+        case OpCode::NewMap:        return "NewMap";
+        case OpCode::MapSet:        return "MapSet";
+        case OpCode::Concat:        return "Concat";
+        case OpCode::AppendConcat:  return "AppendConcat";
+        case OpCode::Call:          return "Call";
+        case OpCode::CallNamed:     return "CallNamed";
+        case OpCode::CallMethod:    return "CallMethod";
+        case OpCode::MakeClosure:   return "MakeClosure";
+        case OpCode::OnHandler:     return "OnHandler";
+        case OpCode::PushScope:     return "PushScope";
+        case OpCode::PopScope:      return "PopScope";
+        case OpCode::ForPrep:       return "ForPrep";
+        case OpCode::ForNext:       return "ForNext";
+        case OpCode::ForNextPair:   return "ForNextPair";
+        case OpCode::Source:        return "Source";
+        case OpCode::Return:        return "Return";
+    }
+    return "?";
+}
+
+std::string disassemble(const Chunk& chunk) {
+    std::string out = "; " + chunk.name + " (" + std::to_string(chunk.numRegisters) +
+                      " registers)\n";
+    char line[96];
+    for (size_t pc = 0; pc < chunk.code.size(); pc++) {
+        const auto& ins = chunk.code[pc];
+        std::snprintf(line, sizeof(line), "%04zu  %-14s %5u %5u %5u\n", pc,
+                      opCodeName(ins.op), ins.a, ins.b, ins.c);
+        out += line;
+    }
+    for (const auto& fn : chunk.functions) {
+        out += disassemble(*fn);
+    }
+    return out;
+}
+
+} // namespace finescript
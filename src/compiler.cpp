@@ -0,0 +1,643 @@
+#include "finescript/compiler.h"
+#include "finescript/ast.h"
+#include "finescript/interner.h"
+#include "finescript/error.h"
+#include <limits>
+#include <unordered_map>
+
+namespace finescript {
+
+namespace {
+
+/// A scope as the compiler sees it. `layout` is null for a script's own
+/// scope, whose names are only known at run time.
+struct LexicalScope {
+    std::shared_ptr<ScopeLayout> layout;
+    std::unordered_map<uint32_t, uint16_t> slots;
+};
+
+/// Result of resolving a name against the enclosing lexical scopes.
+struct Resolution {
+    bool found = false;
+    uint16_t depth = 0;
+    uint16_t slot = 0;
+};
+
+/// Compiles one function (or script) body into a Chunk. Registers are
+/// allocated stack-wise: every expression is compiled into a destination
+/// register, and temporaries above it are released once it is done.
+class FunctionCompiler {
+public:
+    FunctionCompiler(Interner& interner, std::shared_ptr<const AstNode> astRoot,
+                     const FunctionCompiler* enclosing = nullptr)
+        : interner_(interner), astRoot_(std::move(astRoot)), enclosing_(enclosing),
+          enclosingDepth_(enclosing ? enclosing->scopes_.size() : 0) {}
+
+    std::shared_ptr<Chunk> compileChunk(const AstNode& body, const AstNode* fnNode,
+                                        std::string name) {
+        chunk_ = std::make_shared<Chunk>();
+        chunk_->node = fnNode;
+        chunk_->astRoot = astRoot_;
+        chunk_->interner = &interner_;
+        chunk_->name = std::move(name);
+
+        // Function bodies get a call scope with slots for their parameters and
+        // locals; a script runs in a caller-provided scope, resolved by name.
+        if (fnNode) {
+            LexicalScope scope = newScope();
+            if (fnNode->kind == AstNodeKind::Fn) {
+                for (uint32_t param : fnNode->nameIds) declare(scope, param, fnNode->loc);
+                declare(scope, fnNode->restId, fnNode->loc);
+                declare(scope, fnNode->kwargsId, fnNode->loc);
+            }
+            collectLocals(body, scope, true, false);
+            chunk_->layout = scope.layout;
+            scopes_.push_back(std::move(scope));
+        } else {
+            scopes_.push_back(LexicalScope{});
+        }
+
+        uint16_t result = allocReg(body.loc);
+        compile(body, result);
+        emit(OpCode::Return, result, 0, 0, body.loc);
+        return std::move(chunk_);
+    }
+
+private:
+    Interner& interner_;
+    std::shared_ptr<const AstNode> astRoot_;
+    std::shared_ptr<Chunk> chunk_;
+    uint16_t nextReg_ = 0;
+    std::unordered_map<uint32_t, uint16_t> symbolIndex_;
+    std::unordered_map<uint32_t, uint16_t> outerRefIndex_;
+
+    // Lexical scopes of this function, innermost last, and where this
+    // function sits in its enclosing function's scopes
+    std::vector<LexicalScope> scopes_;
+    const FunctionCompiler* enclosing_;
+    size_t enclosingDepth_;
+
+    // ---- Emission helpers ----
+
+    size_t emit(OpCode op, uint16_t a, uint16_t b, uint16_t c, SourceLocation loc) {
+        Instruction ins;
+        ins.op = op;
+        ins.a = a;
+        ins.b = b;
+        ins.c = c;
+        chunk_->code.push_back(ins);
+        chunk_->locations.push_back(loc);
+        return chunk_->code.size() - 1;
+    }
+
+    size_t emitBx(OpCode op, uint16_t a, uint32_t bx, SourceLocation loc) {
+        size_t at = emit(op, a, 0, 0, loc);
+        chunk_->code[at].setBx(bx);
+        return at;
+    }
+
+    size_t emitJump(OpCode op, uint16_t a, SourceLocation loc) {
+        return emitBx(op, a, 0, loc);
+    }
+
+    void patchJump(size_t at) {
+        chunk_->code[at].setBx(static_cast<uint32_t>(chunk_->code.size()));
+    }
+
+    uint32_t here() const {
+        return static_cast<uint32_t>(chunk_->code.size());
+    }
+
+    uint16_t allocReg(SourceLocation loc) {
+        if (nextReg_ == std::numeric_limits<uint16_t>::max()) {
+            throw ScriptError("Expression too complex (out of registers)", loc);
+        }
+        uint16_t r = nextReg_++;
+        if (nextReg_ > chunk_->numRegisters) chunk_->numRegisters = nextReg_;
+        return r;
+    }
+
+    uint16_t symbol(uint32_t id, SourceLocation loc) {
+        auto it = symbolIndex_.find(id);
+        if (it != symbolIndex_.end()) return it->second;
+        if (chunk_->symbols.size() >= std::numeric_limits<uint16_t>::max()) {
+            throw ScriptError("Too many distinct names in one function", loc);
+        }
+        auto idx = static_cast<uint16_t>(chunk_->symbols.size());
+        chunk_->symbols.push_back(id);
+        symbolIndex_[id] = idx;
+        return idx;
+    }
+
+    uint16_t fieldSite(uint32_t id, SourceLocation loc) {
+        if (chunk_->fields.size() >= std::numeric_limits<uint16_t>::max()) {
+            throw ScriptError("Too many field accesses in one function", loc);
+        }
+        FieldSite site;
+        site.sym = symbol(id, loc);
+        chunk_->fields.push_back(site);
+        return static_cast<uint16_t>(chunk_->fields.size() - 1);
+    }
+
+    uint32_t constant(Value v) {
+        chunk_->constants.push_back(std::move(v));
+        return static_cast<uint32_t>(chunk_->constants.size() - 1);
+    }
+
+    uint32_t function(const AstNode& fnNode, const AstNode& body, std::string name) {
+        FunctionCompiler sub(interner_, astRoot_, this);
+        chunk_->functions.push_back(sub.compileChunk(body, &fnNode, std::move(name)));
+        return static_cast<uint32_t>(chunk_->functions.size() - 1);
+    }
+
+    // ---- Name resolution ----
+
+    static LexicalScope newScope() {
+        LexicalScope scope;
+        scope.layout = std::make_shared<ScopeLayout>();
+        return scope;
+    }
+
+    void declare(LexicalScope& scope, uint32_t id, SourceLocation loc) {
+        if (id == kNoSymbol || scope.slots.count(id)) return;
+        if (scope.layout->names.size() >= std::numeric_limits<uint16_t>::max()) {
+            throw ScriptError("Too many local variables in one scope", loc);
+        }
+        scope.slots[id] = static_cast<uint16_t>(scope.layout->names.size());
+        scope.layout->names.push_back(id);
+    }
+
+    /// Collect the names `node` binds in `scope`: `let` targets and named
+    /// functions, plus simple `set` targets when `includeSets` (function
+    /// scopes). Fn/on bodies have scopes of their own; nested `for` bodies
+    /// only contribute their `set` targets.
+    void collectLocals(const AstNode& node, LexicalScope& scope, bool includeSets, bool inFor) {
+        switch (node.kind) {
+            case AstNodeKind::Fn:
+                if (!inFor) declare(scope, node.symbolId, node.loc);
+                return;
+            case AstNodeKind::On:
+                return;
+            case AstNodeKind::Let:
+                if (!inFor) declare(scope, node.nameIds[0], node.loc);
+                break;
+            case AstNodeKind::Set:
+                if (includeSets && node.nameIds.size() == 1) {
+                    declare(scope, node.nameIds[0], node.loc);
+                }
+                break;
+            case AstNodeKind::For:
+                collectLocals(*node.children[0], scope, includeSets, inFor);
+                if (includeSets) collectLocals(*node.children[1], scope, includeSets, true);
+                return;
+            default:
+                break;
+        }
+        for (const auto& child : node.children) {
+            collectLocals(*child, scope, includeSets, inFor);
+        }
+    }
+
+    /// Find the nearest scope declaring `id`. Stops at a script scope,
+    /// since names there (and beyond) are only known at run time.
+    Resolution resolve(uint32_t id) const {
+        size_t depth = 0;
+        size_t visible = scopes_.size();
+        for (const FunctionCompiler* fc = this; fc; fc = fc->enclosing_) {
+            for (size_t i = visible; i-- > 0;) {
+                const auto& scope = fc->scopes_[i];
+                if (!scope.layout) return {};
+                auto it = scope.slots.find(id);
+                if (it != scope.slots.end()) {
+                    if (depth > std::numeric_limits<uint16_t>::max()) return {};
+                    return {true, static_cast<uint16_t>(depth), it->second};
+                }
+                depth++;
+            }
+            visible = fc->enclosingDepth_;
+        }
+        return {};
+    }
+
+    uint16_t outerRef(const Resolution& res, uint16_t sym, SourceLocation loc) {
+        uint32_t key = (static_cast<uint32_t>(res.depth) << 16) | res.slot;
+        auto it = outerRefIndex_.find(key);
+        if (it != outerRefIndex_.end()) return it->second;
+        if (chunk_->outerRefs.size() >= std::numeric_limits<uint16_t>::max()) {
+            throw ScriptError("Too many captured variables in one function", loc);
+        }
+        auto idx = static_cast<uint16_t>(chunk_->outerRefs.size());
+        chunk_->outerRefs.push_back({res.depth, res.slot, sym});
+        outerRefIndex_[key] = idx;
+        return idx;
+    }
+
+    /// Emit a read (Get*) or write (Set*) of a simple name through the
+    /// fastest path its resolution allows.
+    void emitNameAccess(bool write, uint32_t id, uint16_t reg, SourceLocation loc) {
+        uint16_t sym = symbol(id, loc);
+        Resolution res = resolve(id);
+        if (!res.found) {
+            emit(write ? OpCode::SetName : OpCode::GetName, reg, sym, 0, loc);
+        } else if (res.depth == 0) {
+            emit(write ? OpCode::SetLocal : OpCode::GetLocal, reg, res.slot, sym, loc);
+        } else {
+            emit(write ? OpCode::SetOuter : OpCode::GetOuter, reg, outerRef(res, sym, loc), 0, loc);
+        }
+    }
+
+    /// Emit `let`-style definition of `name` in the innermost scope.
+    void emitDefine(uint32_t id, uint16_t reg, SourceLocation loc) {
+        const auto& scope = scopes_.back();
+        if (scope.layout) {
+            auto it = scope.slots.find(id);
+            if (it != scope.slots.end()) {
+                emit(OpCode::DefineLocal, reg, it->second, 0, loc);
+                return;
+            }
+        }
+        emit(OpCode::DefineName, reg, symbol(id, loc), 0, loc);
+    }
+
+    // ---- Expressions ----
+
+    /// Compile `node` so that its value ends up in register `dst`.
+    void compile(const AstNode& node, uint16_t dst) {
+        uint16_t mark = nextReg_;
+        switch (node.kind) {
+            case AstNodeKind::IntLit:
+                if (node.intValue >= std::numeric_limits<int32_t>::min() &&
+                    node.intValue <= std::numeric_limits<int32_t>::max()) {
+                    emitBx(OpCode::LoadInt, dst,
+                           static_cast<uint32_t>(static_cast<int32_t>(node.intValue)), node.loc);
+                } else {
+                    emitBx(OpCode::LoadConst, dst, constant(Value::integer(node.intValue)), node.loc);
+                }
+                break;
+            case AstNodeKind::FloatLit:
+                emitBx(OpCode::LoadConst, dst, constant(Value::number(node.floatValue)), node.loc);
+                break;
+            case AstNodeKind::StringLit:
+                emitBx(OpCode::LoadString, dst, constant(literal(node)), node.loc);
+                break;
+            case AstNodeKind::StringInterp:
+                compileSequence(OpCode::Concat, node, dst);
+                break;
+            case AstNodeKind::SymbolLit:
+                emitBx(OpCode::LoadConst, dst,
+                       constant(Value::symbol(node.symbolId)), node.loc);
+                break;
+            case AstNodeKind::BoolLit:
+                emit(OpCode::LoadBool, dst, node.boolValue ? 1 : 0, 0, node.loc);
+                break;
+            case AstNodeKind::NilLit:
+                emit(OpCode::LoadNil, dst, 0, 0, node.loc);
+                break;
+            case AstNodeKind::ArrayLit:
+                compileSequence(OpCode::NewArray, node, dst);
+                break;
+            case AstNodeKind::Name:
+                emitNameAccess(false, node.symbolId, dst, node.loc);
+                break;
+            case AstNodeKind::DottedName:
+                compile(*node.children[0], dst);
+                for (uint32_t field : node.nameIds) {
+                    emit(OpCode::GetField, dst, dst, fieldSite(field, node.loc), node.loc);
+                }
+                break;
+            case AstNodeKind::Call:        compileCall(node, dst); break;
+            case AstNodeKind::Infix:       compileInfix(node, dst); break;
+            case AstNodeKind::UnaryNot:
+                compile(*node.children[0], dst);
+                emit(OpCode::Not, dst, dst, 0, node.loc);
+                break;
+            case AstNodeKind::UnaryNegate:
+                compile(*node.children[0], dst);
+                emit(OpCode::Negate, dst, dst, 0, node.loc);
+                break;
+            case AstNodeKind::Block:
+                if (node.children.empty()) {
+                    emit(OpCode::LoadNil, dst, 0, 0, node.loc);
+                }
+                for (auto& child : node.children) {
+                    compile(*child, dst);
+                }
+                break;
+            case AstNodeKind::Index: {
+                compile(*node.children[0], dst);
+                uint16_t idx = allocReg(node.loc);
+                compile(*node.children[1], idx);
+                emit(OpCode::Index, dst, dst, idx, node.loc);
+                break;
+            }
+            case AstNodeKind::Ref:
+                compile(*node.children[0], dst);
+                break;
+            case AstNodeKind::MapLit: {
+                emit(OpCode::NewMap, dst, 0, 0, node.loc);
+                uint16_t val = allocReg(node.loc);
+                for (size_t i = 0; i < node.nameParts.size(); i++) {
+                    compile(*node.children[i], val);
+                    emit(OpCode::MapSet, dst, val, symbol(node.nameIds[i], node.loc), node.loc);
+                }
+                break;
+            }
+            case AstNodeKind::Set:         compileSet(node, dst); break;
+            case AstNodeKind::Let:
+                compile(*node.children[0], dst);
+                emitDefine(node.nameIds[0], dst, node.loc);
+                break;
+            case AstNodeKind::Fn:
+                emitBx(OpCode::MakeClosure, dst,
+                       function(node, *node.children[0], node.stringValue), node.loc);
+                break;
+            case AstNodeKind::If:          compileIf(node, dst); break;
+            case AstNodeKind::For:         compileFor(node, dst); break;
+            case AstNodeKind::While:       compileWhile(node, dst); break;
+            case AstNodeKind::Match:       compileMatch(node, dst); break;
+            case AstNodeKind::On:
+                emitBx(OpCode::OnHandler, dst,
+                       function(node, *node.children[0], "on:" + node.stringValue), node.loc);
+                break;
+            case AstNodeKind::Return:
+                if (node.children.empty()) {
+                    emit(OpCode::LoadNil, dst, 0, 0, node.loc);
+                } else {
+                    compile(*node.children[0], dst);
+                }
+                emit(OpCode::Return, dst, 0, 1, node.loc);
+                break;
+            case AstNodeKind::Source: {
+                uint16_t file = allocReg(node.loc);
+                compile(*node.children[0], file);
+                emit(OpCode::Source, dst, file, 0, node.loc);
+                break;
+            }
+            default:
+                throw ScriptError("Unknown AST node kind", node.loc);
+        }
+        nextReg_ = mark;
+    }
+
+    /// Evaluate all children into consecutive registers, then combine them.
+    /// A string literal's shared value (see Value::sharedString).
+    static Value literal(const AstNode& node) {
+        return node.literal.isNil() ? Value::sharedString(node.stringValue) : node.literal;
+    }
+
+    /// Compile a value that is only read, never kept or mutated: string
+    /// literals load the shared constant instead of a fresh copy.
+    void compileOperand(const AstNode& node, uint16_t dst) {
+        if (node.kind == AstNodeKind::StringLit) {
+            emitBx(OpCode::LoadConst, dst, constant(literal(node)), node.loc);
+        } else {
+            compile(node, dst);
+        }
+    }
+
+    void compileSequence(OpCode op, const AstNode& node, uint16_t dst) {
+        uint16_t first = nextReg_;
+        for (auto& child : node.children) {
+            if (op == OpCode::Concat) {
+                compileOperand(*child, allocReg(child->loc));
+            } else {
+                compile(*child, allocReg(child->loc));
+            }
+        }
+        emit(op, dst, first, static_cast<uint16_t>(node.children.size()), node.loc);
+    }
+
+    void compileCall(const AstNode& node, uint16_t dst) {
+        auto& verbNode = *node.children[0];
+        size_t numNamed = node.nameParts.size();
+        size_t numPos = node.children.size() - 1 - numNamed;
+        bool isMethod = verbNode.kind == AstNodeKind::DottedName && !verbNode.nameParts.empty();
+
+        // Layout: [callee-or-base, positional..., named values...]
+        uint16_t base = allocReg(node.loc);
+        compile(isMethod ? *verbNode.children[0] : verbNode, base);
+        for (size_t i = 1; i < node.children.size(); i++) {
+            compile(*node.children[i], allocReg(node.children[i]->loc));
+        }
+
+        if (!isMethod && numNamed == 0) {
+            emit(OpCode::Call, dst, base, static_cast<uint16_t>(numPos), node.loc);
+            return;
+        }
+
+        CallSite site;
+        site.numPositional = static_cast<uint16_t>(numPos);
+        for (uint32_t key : node.nameIds) {
+            site.namedKeys.push_back(symbol(key, node.loc));
+        }
+        if (isMethod) {
+            for (uint32_t field : verbNode.nameIds) {
+                site.path.push_back(symbol(field, node.loc));
+            }
+            site.pathCaches.resize(site.path.size());
+        }
+        chunk_->calls.push_back(std::move(site));
+        auto siteIdx = static_cast<uint16_t>(chunk_->calls.size() - 1);
+        emit(isMethod ? OpCode::CallMethod : OpCode::CallNamed, dst, base, siteIdx, node.loc);
+    }
+
+    void compileInfix(const AstNode& node, uint16_t dst) {
+        // Short-circuit operators: keep the left value unless we need the right
+        OpCode shortCircuit = OpCode::Jump;
+        switch (node.binOp) {
+            case BinaryOp::And:           shortCircuit = OpCode::JumpIfFalse; break;
+            case BinaryOp::Or:
+            case BinaryOp::FalsyCoalesce: shortCircuit = OpCode::JumpIfTrue; break;
+            case BinaryOp::NilCoalesce:   shortCircuit = OpCode::JumpIfNotNil; break;
+            default: break;
+        }
+
+        if (shortCircuit != OpCode::Jump) {
+            // The result is one of the operands, so it must be a value of its own
+            compile(*node.children[0], dst);
+            size_t skip = emitJump(shortCircuit, dst, node.loc);
+            compile(*node.children[1], dst);
+            patchJump(skip);
+            return;
+        }
+
+        compileOperand(*node.children[0], dst);
+        uint16_t right = allocReg(node.loc);
+        compileOperand(*node.children[1], right);
+        emit(binaryOpCode(node), dst, dst, right, node.loc);
+    }
+
+    static OpCode binaryOpCode(const AstNode& node) {
+        switch (node.binOp) {
+            case BinaryOp::Add:       return OpCode::Add;
+            case BinaryOp::Sub:       return OpCode::Sub;
+            case BinaryOp::Mul:       return OpCode::Mul;
+            case BinaryOp::Div:       return OpCode::Div;
+            case BinaryOp::Mod:       return OpCode::Mod;
+            case BinaryOp::Eq:        return OpCode::Eq;
+            case BinaryOp::Ne:        return OpCode::Ne;
+            case BinaryOp::Lt:        return OpCode::Lt;
+            case BinaryOp::Gt:        return OpCode::Gt;
+            case BinaryOp::Le:        return OpCode::Le;
+            case BinaryOp::Ge:        return OpCode::Ge;
+            case BinaryOp::Range:     return OpCode::Range;
+            case BinaryOp::RangeIncl: return OpCode::RangeIncl;
+            default: break;
+        }
+        throw ScriptError("Unknown operator '" + node.op + "'", node.loc);
+    }
+
+    void compileSet(const AstNode& node, uint16_t dst) {
+        if (node.selfAppend) {
+            // set s (s + x) / set s "{s}...": Append* must precede the store
+            const AstNode& value = *node.children[0];
+            const AstNode& head = *value.children[0];
+            if (head.kind == AstNodeKind::Call) {
+                // Interpolated {s}: a zero-arg call, which keeps a string as is
+                emitNameAccess(false, head.children[0]->symbolId, dst, head.loc);
+                emit(OpCode::Call, dst, dst, 0, head.loc);
+            } else {
+                compile(head, dst);
+            }
+            uint16_t first = nextReg_;
+            for (size_t i = 1; i < value.children.size(); i++) {
+                compileOperand(*value.children[i], allocReg(value.children[i]->loc));
+            }
+            if (value.kind == AstNodeKind::StringInterp) {
+                emit(OpCode::AppendConcat, dst, first,
+                     static_cast<uint16_t>(value.children.size() - 1), value.loc);
+            } else {
+                emit(OpCode::Append, dst, dst, first, value.loc);
+            }
+            emitNameAccess(true, node.nameIds[0], dst, node.loc);
+            return;
+        }
+
+        compile(*node.children[0], dst);
+
+        if (node.nameParts.size() == 1) {
+            emitNameAccess(true, node.nameIds[0], dst, node.loc);
+            return;
+        }
+
+        // Dotted: set a.b.c v -- navigate to the penultimate map, set field on it
+        uint16_t target = allocReg(node.loc);
+        emit(OpCode::GetNameStrict, target, symbol(node.nameIds[0], node.loc), 0, node.loc);
+        for (size_t i = 1; i + 1 < node.nameIds.size(); i++) {
+            emit(OpCode::GetMember, target, target, fieldSite(node.nameIds[i], node.loc), node.loc);
+        }
+        emit(OpCode::SetField, target, dst, fieldSite(node.nameIds.back(), node.loc), node.loc);
+    }
+
+    void compileIf(const AstNode& node, uint16_t dst) {
+        // children: [cond1, body1, cond2, body2, ...] with optional else body at end
+        size_t numChildren = node.children.size();
+        size_t pairs = node.hasElse ? (numChildren - 1) / 2 : numChildren / 2;
+
+        std::vector<size_t> exits;
+        for (size_t i = 0; i < pairs; i++) {
+            compile(*node.children[i * 2], dst);
+            size_t next = emitJump(OpCode::JumpIfFalse, dst, node.loc);
+            compile(*node.children[i * 2 + 1], dst);
+            exits.push_back(emitJump(OpCode::Jump, 0, node.loc));
+            patchJump(next);
+        }
+
+        if (node.hasElse) {
+            compile(*node.children.back(), dst);
+        } else {
+            emit(OpCode::LoadNil, dst, 0, 0, node.loc);
+        }
+        for (size_t at : exits) patchJump(at);
+    }
+
+    void compileWhile(const AstNode& node, uint16_t dst) {
+        emit(OpCode::LoadNil, dst, 0, 0, node.loc);
+        uint32_t loop = here();
+        uint16_t cond = allocReg(node.loc);
+        compile(*node.children[0], cond);
+        size_t exit = emitJump(OpCode::JumpIfFalse, cond, node.loc);
+        compile(*node.children[1], dst);
+        emitBx(OpCode::Jump, 0, loop, node.loc);
+        patchJump(exit);
+    }
+
+    void compileFor(const AstNode& node, uint16_t dst) {
+        // Registers: iterable, cursor, current element[, its key or index]
+        bool pairs = node.nameIds.size() > 1;
+        uint16_t iter = allocReg(node.loc);
+        allocReg(node.loc);
+        uint16_t elem = allocReg(node.loc);
+        uint16_t key = pairs ? allocReg(node.loc) : elem;
+
+        compile(*node.children[0], iter);
+
+        // The loop scope holds the loop variables and the body's `let`s
+        LexicalScope scope = newScope();
+        for (uint32_t var : node.nameIds) declare(scope, var, node.loc);
+        uint16_t keySlot = scope.slots[node.nameIds[0]];
+        uint16_t valueSlot = scope.slots[node.nameIds.back()];
+        collectLocals(*node.children[1], scope, false, false);
+        chunk_->scopeLayouts.push_back(scope.layout);
+        emitBx(OpCode::PushScope, 0, static_cast<uint32_t>(chunk_->scopeLayouts.size() - 1),
+               node.loc);
+        scopes_.push_back(std::move(scope));
+
+        emit(OpCode::LoadNil, elem, 0, 0, node.loc);
+        emit(OpCode::DefineLocal, elem, keySlot, 0, node.loc);
+        if (pairs) emit(OpCode::DefineLocal, elem, valueSlot, 0, node.loc);
+        emit(OpCode::ForPrep, iter, 0, 0, node.loc);
+        emit(OpCode::LoadNil, dst, 0, 0, node.loc);
+
+        uint32_t loop = here();
+        size_t exit = emitJump(pairs ? OpCode::ForNextPair : OpCode::ForNext, iter, node.loc);
+        emit(OpCode::DefineLocal, key, keySlot, 0, node.loc);
+        if (pairs) emit(OpCode::DefineLocal, elem, valueSlot, 0, node.loc);
+        compile(*node.children[1], dst);
+        emitBx(OpCode::Jump, 0, loop, node.loc);
+        patchJump(exit);
+        emit(OpCode::PopScope, 0, 0, 0, node.loc);
+        scopes_.pop_back();
+    }
+
+    void compileMatch(const AstNode& node, uint16_t dst) {
+        // children[0] = scrutinee, then pairs: [pattern, body, pattern, body, ...]
+        uint16_t scrutinee = allocReg(node.loc);
+        compile(*node.children[0], scrutinee);
+
+        std::vector<size_t> exits;
+        for (size_t i = 1; i + 1 < node.children.size(); i += 2) {
+            auto& pattern = *node.children[i];
+
+            // Wildcard: _ matches anything, later arms are unreachable
+            if (pattern.kind == AstNodeKind::Name && pattern.stringValue == "_") {
+                compile(*node.children[i + 1], dst);
+                exits.push_back(emitJump(OpCode::Jump, 0, node.loc));
+                break;
+            }
+
+            uint16_t test = allocReg(pattern.loc);
+            compileOperand(pattern, test);
+            emit(OpCode::Eq, test, scrutinee, test, pattern.loc);
+            size_t next = emitJump(OpCode::JumpIfFalse, test, pattern.loc);
+            nextReg_ = test;
+            compile(*node.children[i + 1], dst);
+            exits.push_back(emitJump(OpCode::Jump, 0, node.loc));
+            patchJump(next);
+        }
+
+        emit(OpCode::LoadNil, dst, 0, 0, node.loc); // no match
+        for (size_t at : exits) patchJump(at);
+    }
+};
+
+} // anonymous namespace
+
+std::shared_ptr<const Chunk> Compiler::compile(std::shared_ptr<AstNode> root,
+                                               Interner& interner, std::string name) {
+    if (root->boundInterner != &interner) bindSymbols(*root, interner);
+    FunctionCompiler compiler(interner, root);
+    return compiler.compileChunk(*root, nullptr, std::move(name));
+}
+
+} // namespace finescript
@@ -9,68 +9,104 @@
 #include "finescript/format_util.h"
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace finescript {
 
+namespace {
+
+/// Points currentAstRoot_ at a program for the duration of its evaluation
+/// and restores the previous root even if evaluation throws, so a reused
+/// evaluator never hands a stale root to the closures it creates later.
+struct AstRootGuard {
+    std::shared_ptr<const AstNode>& slot;
+    std::shared_ptr<const AstNode> prev;
+
+    AstRootGuard(std::shared_ptr<const AstNode>& s, std::shared_ptr<const AstNode> root)
+        : slot(s), prev(std::move(s)) {
+        slot = std::move(root);
+    }
+    ~AstRootGuard() { slot = std::move(prev); }
+};
+
+/// `map.keys`: the keys as symbols, in the map's order.
+Value mapKeys(const MapData& map) {
+    std::vector<Value> result;
+    result.reserve(map.size());
+    map.forEach([&](uint32_t key, const Value&) { result.push_back(Value::symbol(key)); });
+    return Value::array(std::move(result));
+}
+
+/// Byte length of the UTF-8 character starting at `pos`. A malformed or
+/// truncated sequence counts as one byte, so any string can be walked.
+size_t utf8CharLength(const std::string& str, size_t pos) {
+    auto lead = static_cast<unsigned char>(str[pos]);
+    size_t len = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3
+               : (lead >> 3) == 0x1E ? 4 : 1;
+    if (len > str.size() - pos) return 1;
+    for (size_t i = 1; i < len; i++) {
+        if ((static_cast<unsigned char>(str[pos + i]) & 0xC0) != 0x80) return 1;
+    }
+    return len;
+}
+
+} // anonymous namespace
+
 Evaluator::Evaluator(Interner& interner, std::shared_ptr<Scope> globalScope,
                      ScriptEngine* engine)
     : interner_(interner), globalScope_(std::move(globalScope)), engine_(engine) {
     preInternSymbols();
+    initMethodTables();
 }
 
 void Evaluator::preInternSymbols() {
-    sym_get_ = interner_.intern("get");
-    sym_set_ = interner_.intern("set");
-    sym_has_ = interner_.intern("has");
-    sym_remove_ = interner_.intern("remove");
-    sym_keys_ = interner_.intern("keys");
-    sym_values_ = interner_.intern("values");
-    sym_length_ = interner_.intern("length");
-    sym_push_ = interner_.intern("push");
-    sym_pop_ = interner_.intern("pop");
-    sym_setMethod_ = interner_.intern("setMethod");
-    sym_slice_ = interner_.intern("slice");
-    sym_contains_ = interner_.intern("contains");
-    sym_sort_ = interner_.intern("sort");
-    sym_map_ = interner_.intern("map");
-    sym_filter_ = interner_.intern("filter");
-    sym_foreach_ = interner_.intern("foreach");
-    // String methods
-    sym_insert_ = interner_.intern("insert");
-    sym_delete_ = interner_.intern("delete");
-    sym_replace_ = interner_.intern("replace");
-    sym_split_ = interner_.intern("split");
-    sym_substr_ = interner_.intern("substr");
-    sym_find_ = interner_.intern("find");
-    sym_upper_ = interner_.intern("upper");
-    sym_lower_ = interner_.intern("lower");
-    sym_trim_ = interner_.intern("trim");
-    sym_starts_with_ = interner_.intern("starts_with");
-    sym_ends_with_ = interner_.intern("ends_with");
-    sym_char_at_ = interner_.intern("char_at");
-    sym_sort_by_ = interner_.intern("sort_by");
-    sym_self_ = interner_.intern("self");
+    builtinIdsFixed_ = true;
+    builtinsById_.clear();
+    for (uint32_t i = 0; i < kBuiltinSymbolCount; i++) {
+        builtinIds_[i] = interner_.intern(kBuiltinSymbolNames[i]);
+        builtinIdsFixed_ = builtinIdsFixed_ && builtinIds_[i] == i;
+        builtinsById_.emplace_back(builtinIds_[i], static_cast<BuiltinSymbol>(i));
+    }
+    std::sort(builtinsById_.begin(), builtinsById_.end());
+}
+
+BuiltinSymbol Evaluator::lookupBuiltinSymbol(uint32_t id) const {
+    auto it = std::lower_bound(builtinsById_.begin(), builtinsById_.end(),
+                               std::make_pair(id, BuiltinSymbol(0)));
+    return it != builtinsById_.end() && it->first == id ? it->second : BuiltinSymbol::Count;
 }
 
 bool Evaluator::isAutoMethod(const Value& val) const {
     if (!val.isClosure()) return false;
     auto& closure = const_cast<Value&>(val).asClosure();
-    return !closure.paramIds.empty() && closure.paramIds[0] == sym_self_;
+    return !closure.paramIds.empty() && closure.paramIds[0] == builtinId(BuiltinSymbol::Self);
 }
 
 // -- Main dispatch --
 
 Value Evaluator::eval(std::shared_ptr<AstNode> root, std::shared_ptr<Scope> scope,
                       ExecutionContext* ctx) {
-    auto prevRoot = currentAstRoot_;
-    currentAstRoot_ = root;
-    Value result = eval(*root, scope, ctx);
-    currentAstRoot_ = prevRoot;
-    return result;
+    if (root->boundInterner != &interner_) bindSymbols(*root, interner_);
+    AstRootGuard guard(currentAstRoot_, root);
+    return eval(*root, scope, ctx);
 }
 
 Value Evaluator::eval(const AstNode& node, std::shared_ptr<Scope> scope,
                       ExecutionContext* ctx) {
+    // A top-level `return` ends the program with its value
+    return takeReturn(evalNode(node, *scope, ctx));
+}
+
+Value Evaluator::takeReturn(Value result) {
+    if (completion_ == Completion::Return) {
+        completion_ = Completion::Normal;
+        return std::move(completionValue_);
+    }
+    return result;
+}
+
+Value Evaluator::evalNode(const AstNode& node, Scope& scope,
+                          ExecutionContext* ctx) {
     switch (node.kind) {
         case AstNodeKind::IntLit:      return evalIntLit(node);
         case AstNodeKind::FloatLit:    return evalFloatLit(node);
@@ -115,22 +151,43 @@ Value Evaluator::evalFloatLit(const AstNode& node) {
 }
 
 Value Evaluator::evalStringLit(const AstNode& node) {
+    // Strings are mutable, so each evaluation hands out its own copy
     return Value::string(node.stringValue);
 }
 
-Value Evaluator::evalStringInterp(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalOperand(const AstNode& node, Scope& scope, ExecutionContext* ctx) {
+    if (node.kind == AstNodeKind::StringLit && !node.literal.isNil()) return node.literal;
+    return evalNode(node, scope, ctx);
+}
+
+Value Evaluator::evalStringInterp(const AstNode& node, Scope& scope,
+                                   ExecutionContext* ctx) {
+    std::string result = interpolate(node, 0, scope, ctx);
+    if (unwinding()) return Value::nil();
+    return Value::string(std::move(result));
+}
+
+std::string Evaluator::interpolate(const AstNode& node, size_t first, Scope& scope,
                                    ExecutionContext* ctx) {
+    // Size the result up front: literal parts exactly, others by a guess
+    size_t size = 0;
+    for (size_t i = first; i < node.children.size(); i++) {
+        const AstNode& part = *node.children[i];
+        size += part.kind == AstNodeKind::StringLit ? part.stringValue.size() : 16;
+    }
     std::string result;
-    for (auto& child : node.children) {
-        Value v = eval(*child, scope, ctx);
-        result += v.toString(&interner_);
+    result.reserve(size);
+    for (size_t i = first; i < node.children.size(); i++) {
+        Value v = evalOperand(*node.children[i], scope, ctx);
+        if (unwinding()) break;
+        if (v.isString()) result += v.asString();
+        else result += v.toString(&interner_);
     }
-    return Value::string(std::move(result));
+    return result;
 }
 
 Value Evaluator::evalSymbolLit(const AstNode& node) {
-    uint32_t sym = interner_.intern(node.stringValue);
-    return Value::symbol(sym);
+    return Value::symbol(node.symbolId);
 }
 
 Value Evaluator::evalBoolLit(const AstNode& node) {
@@ -141,78 +198,78 @@ Value Evaluator::evalNilLit(const AstNode& /*node*/) {
     return Value::nil();
 }
 
-Value Evaluator::evalArrayLit(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalArrayLit(const AstNode& node, Scope& scope,
                                ExecutionContext* ctx) {
     std::vector<Value> elems;
     elems.reserve(node.children.size());
     for (auto& child : node.children) {
-        elems.push_back(eval(*child, scope, ctx));
+        elems.push_back(evalNode(*child, scope, ctx));
+        if (unwinding()) return Value::nil();
     }
     return Value::array(std::move(elems));
 }
 
 // -- Name lookup --
 
-Value Evaluator::evalName(const AstNode& node, std::shared_ptr<Scope> scope) {
-    uint32_t sym = interner_.intern(node.stringValue);
-    Value* v = scope->lookup(sym);
+Value Evaluator::evalName(const AstNode& node, Scope& scope) {
+    Value* v = scope.lookup(node.symbolId);
     if (v) return *v;
     return Value::nil(); // unbound = nil
 }
 
 // -- Dotted name (field access chain) --
 
-Value Evaluator::evalDottedName(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalDottedName(const AstNode& node, Scope& scope,
                                  ExecutionContext* ctx) {
-    Value current = eval(*node.children[0], scope, ctx);
-
-    for (const auto& field : node.nameParts) {
-        uint32_t sym = interner_.intern(field);
+    Value current = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
 
-        if (current.isMap()) {
-            // Built-in zero-arg map properties
-            if (sym == sym_keys_) {
-                auto keys = current.asMap().keys();
-                std::vector<Value> result;
-                for (uint32_t k : keys) result.push_back(Value::symbol(k));
-                current = Value::array(std::move(result));
-            } else if (sym == sym_values_) {
-                auto keys = current.asMap().keys();
-                std::vector<Value> result;
-                for (uint32_t k : keys) result.push_back(current.asMap().get(k));
-                current = Value::array(std::move(result));
-            } else {
-                current = current.asMap().get(sym);
-            }
-        } else if (current.isArray()) {
-            if (sym == sym_length_) {
-                current = Value::integer(static_cast<int64_t>(current.asArray().size()));
-            } else if (sym == sym_pop_) {
-                auto& arr = current.asArrayMut();
-                if (arr.empty()) throw ScriptError("Cannot pop from empty array", node.loc);
-                Value last = arr.back();
-                arr.pop_back();
-                current = last;
-            } else {
-                throw ScriptError("Cannot access field '" + field + "' on array", node.loc);
-            }
-        } else if (current.isString()) {
-            if (sym == sym_length_) {
-                current = Value::integer(static_cast<int64_t>(current.asString().size()));
-            } else {
-                throw ScriptError("Cannot access field '" + field + "' on string", node.loc);
-            }
-        } else {
-            throw ScriptError("Cannot access field '" + field + "' on " + current.typeName(), node.loc);
-        }
+    for (size_t i = 0; i < node.nameIds.size(); i++) {
+        current = getField(current, node.nameIds[i], node.loc, &node.fieldCaches[i]);
     }
 
     return current;
 }
 
+Value Evaluator::getField(const Value& object, uint32_t sym, SourceLocation loc,
+                          FieldCache* cache) {
+    BuiltinSymbol builtin = builtinSymbol(sym);
+    if (object.isMap()) {
+        // Built-in zero-arg map properties
+        if (builtin == BuiltinSymbol::Keys) return mapKeys(object.asMap());
+        if (builtin == BuiltinSymbol::Values) return Value::array(object.asMap().values());
+        if (cache) return object.asMap().get(sym, *cache);
+        return object.asMap().get(sym);
+    }
+    if (object.isArray()) {
+        if (builtin == BuiltinSymbol::Length) {
+            if (auto* range = object.lazyRange()) return Value::integer(range->size());
+            return Value::integer(static_cast<int64_t>(object.asArray().size()));
+        }
+        if (builtin == BuiltinSymbol::Pop) {
+            auto& arr = const_cast<Value&>(object).asArrayMut();
+            if (arr.empty()) throw ScriptError("Cannot pop from empty array", loc);
+            Value last = arr.back();
+            arr.pop_back();
+            return last;
+        }
+        throw ScriptError("Cannot access field '" + std::string(interner_.lookup(sym)) +
+                          "' on array", loc);
+    }
+    if (object.isString()) {
+        if (builtin == BuiltinSymbol::Length) {
+            return Value::integer(static_cast<int64_t>(object.asString().size()));
+        }
+        throw ScriptError("Cannot access field '" + std::string(interner_.lookup(sym)) +
+                          "' on string", loc);
+    }
+    throw ScriptError("Cannot access field '" + std::string(interner_.lookup(sym)) +
+                      "' on " + object.typeName(), loc);
+}
+
 // -- Call (prefix call + method dispatch) --
 
-Value Evaluator::evalCall(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalCall(const AstNode& node, Scope& scope,
                            ExecutionContext* ctx) {
     auto& verbNode = *node.children[0];
     size_t numNamed = node.nameParts.size();  // named arg keys stored in Call's nameParts
@@ -223,8 +280,9 @@ Value Evaluator::evalCall(const AstNode& node, std::shared_ptr<Scope> scope,
     auto evalNamedArgs = [&]() -> std::vector<std::pair<uint32_t, Value>> {
         std::vector<std::pair<uint32_t, Value>> result;
         for (size_t i = 0; i < numNamed; i++) {
-            uint32_t sym = interner_.intern(node.nameParts[i]);
-            Value val = eval(*node.children[numPosArgs + 1 + i], scope, ctx);
+            uint32_t sym = node.nameIds[i];
+            Value val = evalNode(*node.children[numPosArgs + 1 + i], scope, ctx);
+            if (unwinding()) break;
             result.push_back({sym, std::move(val)});
         }
         return result;
@@ -233,13 +291,14 @@ Value Evaluator::evalCall(const AstNode& node, std::shared_ptr<Scope> scope,
     // Method call: verb is DottedName
     if (verbNode.kind == AstNodeKind::DottedName && !verbNode.nameParts.empty()) {
         // Evaluate base and navigate to receiver
-        Value receiver = eval(*verbNode.children[0], scope, ctx);
+        Value receiver = evalNode(*verbNode.children[0], scope, ctx);
+        if (unwinding()) return Value::nil();
 
         // Navigate through all but last field
         for (size_t i = 0; i + 1 < verbNode.nameParts.size(); i++) {
-            uint32_t sym = interner_.intern(verbNode.nameParts[i]);
+            uint32_t sym = verbNode.nameIds[i];
             if (receiver.isMap()) {
-                receiver = receiver.asMap().get(sym);
+                receiver = receiver.asMap().get(sym, verbNode.fieldCaches[i]);
             } else {
                 throw ScriptError("Cannot access field '" + verbNode.nameParts[i] +
                     "' on " + receiver.typeName(), node.loc);
@@ -247,59 +306,57 @@ Value Evaluator::evalCall(const AstNode& node, std::shared_ptr<Scope> scope,
         }
 
         const std::string& methodName = verbNode.nameParts.back();
-        uint32_t methodSym = interner_.intern(methodName);
+        uint32_t methodSym = verbNode.nameIds.back();
 
-        // Evaluate positional arguments only
-        std::vector<Value> args;
+        // Evaluate positional arguments only, after a slot reserved for self
+        ArgBuffer args;
+        args.push_back(Value());
         for (size_t i = 1; i <= numPosArgs; i++) {
-            args.push_back(eval(*node.children[i], scope, ctx));
+            args.push_back(evalNode(*node.children[i], scope, ctx));
+            if (unwinding()) return Value::nil();
         }
 
-        // Check built-in methods (named args not supported for built-ins)
-        if (receiver.isMap() && isBuiltinMapMethod(methodSym)) {
-            return dispatchBuiltinMethod(receiver, methodSym, std::move(args), scope, ctx, node.loc);
-        }
-        if (receiver.isArray() && isBuiltinArrayMethod(methodSym)) {
-            return dispatchBuiltinMethod(receiver, methodSym, std::move(args), scope, ctx, node.loc);
-        }
-        if (receiver.isString() && isBuiltinStringMethod(methodSym)) {
-            return dispatchBuiltinMethod(receiver, methodSym, std::move(args), scope, ctx, node.loc);
+        // Methods of the receiver's type (named args not supported for these)
+        if (const Method* method = findMethod(receiver, methodSym)) {
+            return invokeMethod(*method, receiver, args.span().subspan(1), ctx, node.loc);
         }
 
         // Check map field (user-defined method or stored function)
+        Value func;
+        bool passSelf = false;
         if (receiver.isMap()) {
             MapData& map = receiver.asMap();
-            if (map.has(methodSym)) {
-                Value func = map.get(methodSym);
-                if (map.isMethod(methodSym)) {
-                    // Auto-inject self as first argument
-                    args.insert(args.begin(), receiver);
-                }
+            if (map.lookup(methodSym, verbNode.fieldCaches.back(), func, passSelf)) {
+                // Auto-inject self as first argument
+                if (passSelf) args[0] = receiver;
+                auto callArgs = [&] { return passSelf ? args.span() : args.span().subspan(1); };
                 // Zero-arg access on non-callable field: return value directly
-                if (args.empty() && numNamed == 0 && !func.isCallable()) {
+                if (callArgs().empty() && numNamed == 0 && !func.isCallable()) {
                     return func;
                 }
                 // Named arg dispatch for closures
                 if (numNamed > 0 && func.isClosure()) {
                     auto namedArgs = evalNamedArgs();
+                    if (unwinding()) return Value::nil();
                     auto& closure = func.asClosure();
-                    return callClosureWithNamed(closure, std::move(args), std::move(namedArgs), ctx, node.loc);
+                    return callClosureWithNamed(closure, callArgs(), std::move(namedArgs), ctx, node.loc);
                 }
                 // Named arg dispatch for native functions: collect into kwargs map
                 if (numNamed > 0 && func.isNativeFunction()) {
                     auto namedArgs = evalNamedArgs();
+                    if (unwinding()) return Value::nil();
                     auto kwargsMap = Value::map();
                     for (auto& [sym, val] : namedArgs) {
                         kwargsMap.asMap().set(sym, std::move(val));
                     }
                     args.push_back(std::move(kwargsMap));
                 }
-                return callFunction(func, std::move(args), scope, ctx, node.loc);
+                return invoke(func, callArgs(), ctx, node.loc);
             }
         }
 
         // Zero-arg call with no method found: fall back to evalDottedName for property access
-        if (args.empty() && numNamed == 0) {
+        if (numPosArgs == 0 && numNamed == 0) {
             return evalDottedName(verbNode, scope, ctx);
         }
 
@@ -307,11 +364,13 @@ Value Evaluator::evalCall(const AstNode& node, std::shared_ptr<Scope> scope,
     }
 
     // Regular prefix call
-    Value verb = eval(verbNode, scope, ctx);
+    Value verb = evalNode(verbNode, scope, ctx);
+    if (unwinding()) return Value::nil();
 
-    std::vector<Value> args;
+    ArgBuffer args;
     for (size_t i = 1; i <= numPosArgs; i++) {
-        args.push_back(eval(*node.children[i], scope, ctx));
+        args.push_back(evalNode(*node.children[i], scope, ctx));
+        if (unwinding()) return Value::nil();
     }
 
     // Zero-arg call on non-callable: return the value
@@ -322,13 +381,15 @@ Value Evaluator::evalCall(const AstNode& node, std::shared_ptr<Scope> scope,
     // Named arg dispatch for closures
     if (numNamed > 0 && verb.isClosure()) {
         auto namedArgs = evalNamedArgs();
+        if (unwinding()) return Value::nil();
         auto& closure = const_cast<Value&>(verb).asClosure();
-        return callClosureWithNamed(closure, std::move(args), std::move(namedArgs), ctx, node.loc);
+        return callClosureWithNamed(closure, args, std::move(namedArgs), ctx, node.loc);
     }
 
     // Named arg dispatch for native functions: collect into kwargs map
     if (numNamed > 0 && verb.isNativeFunction()) {
         auto namedArgs = evalNamedArgs();
+        if (unwinding()) return Value::nil();
         auto kwargsMap = Value::map();
         for (auto& [sym, val] : namedArgs) {
             kwargsMap.asMap().set(sym, std::move(val));
@@ -336,54 +397,56 @@ Value Evaluator::evalCall(const AstNode& node, std::shared_ptr<Scope> scope,
         args.push_back(std::move(kwargsMap));
     }
 
-    return callFunction(verb, std::move(args), scope, ctx, node.loc);
+    return invoke(verb, args, ctx, node.loc);
 }
 
 // -- Infix --
 
-Value Evaluator::evalInfix(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalInfix(const AstNode& node, Scope& scope,
                             ExecutionContext* ctx) {
-    const auto& op = node.op;
-
     // Short-circuit operators
-    if (op == "and") {
-        Value left = eval(*node.children[0], scope, ctx);
-        if (!left.truthy()) return left;
-        return eval(*node.children[1], scope, ctx);
-    }
-    if (op == "or") {
-        Value left = eval(*node.children[0], scope, ctx);
-        if (left.truthy()) return left;
-        return eval(*node.children[1], scope, ctx);
-    }
-    if (op == "??") {
-        Value left = eval(*node.children[0], scope, ctx);
-        if (!left.isNil()) return left;
-        return eval(*node.children[1], scope, ctx);
-    }
-    if (op == "?:") {
-        Value left = eval(*node.children[0], scope, ctx);
-        if (left.truthy()) return left;
-        return eval(*node.children[1], scope, ctx);
+    switch (node.binOp) {
+        case BinaryOp::And: {
+            Value left = evalNode(*node.children[0], scope, ctx);
+            if (!left.truthy() || unwinding()) return left;
+            return evalNode(*node.children[1], scope, ctx);
+        }
+        case BinaryOp::Or:
+        case BinaryOp::FalsyCoalesce: {
+            Value left = evalNode(*node.children[0], scope, ctx);
+            if (left.truthy() || unwinding()) return left;
+            return evalNode(*node.children[1], scope, ctx);
+        }
+        case BinaryOp::NilCoalesce: {
+            Value left = evalNode(*node.children[0], scope, ctx);
+            if (!left.isNil() || unwinding()) return left;
+            return evalNode(*node.children[1], scope, ctx);
+        }
+        default:
+            break;
     }
 
-    Value left = eval(*node.children[0], scope, ctx);
-    Value right = eval(*node.children[1], scope, ctx);
+    Value left = evalOperand(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
+    Value right = evalOperand(*node.children[1], scope, ctx);
+    if (unwinding()) return Value::nil();
 
-    return applyBinOp(op, left, right, node.loc);
+    return applyBinOp(node.binOp, left, right, node.loc);
 }
 
 // -- Unary --
 
-Value Evaluator::evalUnaryNot(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalUnaryNot(const AstNode& node, Scope& scope,
                                ExecutionContext* ctx) {
-    Value val = eval(*node.children[0], scope, ctx);
+    Value val = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
     return Value::boolean(!val.truthy());
 }
 
-Value Evaluator::evalUnaryNegate(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalUnaryNegate(const AstNode& node, Scope& scope,
                                   ExecutionContext* ctx) {
-    Value val = eval(*node.children[0], scope, ctx);
+    Value val = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
     if (val.isInt()) return Value::integer(-val.asInt());
     if (val.isFloat()) return Value::number(-val.asFloat());
     throw ScriptError("Cannot negate " + val.typeName(), node.loc);
@@ -391,75 +454,89 @@ Value Evaluator::evalUnaryNegate(const AstNode& node, std::shared_ptr<Scope> sco
 
 // -- Block --
 
-Value Evaluator::evalBlock(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalBlock(const AstNode& node, Scope& scope,
                             ExecutionContext* ctx) {
     Value result;
     for (auto& child : node.children) {
-        result = eval(*child, scope, ctx);
+        evalInto(result, *child, scope, ctx);
+        if (unwinding()) break;
     }
     return result;
 }
 
 // -- Index --
 
-Value Evaluator::evalIndex(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalIndex(const AstNode& node, Scope& scope,
                             ExecutionContext* ctx) {
-    Value target = eval(*node.children[0], scope, ctx);
-    Value index = eval(*node.children[1], scope, ctx);
+    Value target = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
+    Value index = evalNode(*node.children[1], scope, ctx);
+    if (unwinding()) return Value::nil();
+    return indexValue(target, index, node.loc);
+}
 
+Value Evaluator::indexValue(const Value& target, const Value& index, SourceLocation loc) {
     if (target.isArray()) {
         if (!index.isInt()) {
-            throw ScriptError("Array index must be an integer", node.loc);
+            throw ScriptError("Array index must be an integer", loc);
         }
         int64_t idx = index.asInt();
+        if (auto* range = target.lazyRange()) {
+            if (idx < 0) idx += range->size();
+            if (idx < 0 || idx >= range->size()) {
+                throw ScriptError("Array index out of bounds: " + std::to_string(index.asInt()), loc);
+            }
+            return Value::integer(range->start + idx);
+        }
         auto& arr = target.asArray();
         if (idx < 0) idx += static_cast<int64_t>(arr.size());
         if (idx < 0 || idx >= static_cast<int64_t>(arr.size())) {
-            throw ScriptError("Array index out of bounds: " + std::to_string(index.asInt()), node.loc);
+            throw ScriptError("Array index out of bounds: " + std::to_string(index.asInt()), loc);
         }
         return arr[static_cast<size_t>(idx)];
     }
 
     if (target.isString()) {
         if (!index.isInt()) {
-            throw ScriptError("String index must be an integer", node.loc);
+            throw ScriptError("String index must be an integer", loc);
         }
         int64_t idx = index.asInt();
         const auto& str = target.asString();
         if (idx < 0) idx += static_cast<int64_t>(str.size());
         if (idx < 0 || idx >= static_cast<int64_t>(str.size())) {
-            throw ScriptError("String index out of bounds: " + std::to_string(index.asInt()), node.loc);
+            throw ScriptError("String index out of bounds: " + std::to_string(index.asInt()), loc);
         }
         return Value::string(std::string(1, str[static_cast<size_t>(idx)]));
     }
 
     if (target.isMap()) {
         if (!index.isSymbol()) {
-            throw ScriptError("Map key must be a symbol", node.loc);
+            throw ScriptError("Map key must be a symbol", loc);
         }
         return target.asMap().get(index.asSymbol());
     }
 
-    throw ScriptError("Cannot index " + target.typeName(), node.loc);
+    throw ScriptError("Cannot index " + target.typeName(), loc);
 }
 
 // -- Ref (tilde: get value without auto-calling) --
 
-Value Evaluator::evalRef(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalRef(const AstNode& node, Scope& scope,
                           ExecutionContext* ctx) {
-    return eval(*node.children[0], scope, ctx);
+    return evalNode(*node.children[0], scope, ctx);
 }
 
 // -- MapLit --
 
-Value Evaluator::evalMapLit(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalMapLit(const AstNode& node, Scope& scope,
                              ExecutionContext* ctx) {
     Value mapVal = Value::map();
     MapData& map = mapVal.asMap();
 
     for (size_t i = 0; i < node.nameParts.size(); i++) {
-        uint32_t sym = interner_.intern(node.nameParts[i]);
-        Value val = eval(*node.children[i], scope, ctx);
+        uint32_t sym = node.nameIds[i];
+        Value val = evalNode(*node.children[i], scope, ctx);
+        if (unwinding()) return Value::nil();
         map.set(sym, val);
         // Auto-detect methods: closures with first param named "self"
         if (isAutoMethod(val)) {
@@ -472,19 +549,20 @@ Value Evaluator::evalMapLit(const AstNode& node, std::shared_ptr<Scope> scope,
 
 // -- Set --
 
-Value Evaluator::evalSet(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalSet(const AstNode& node, Scope& scope,
                           ExecutionContext* ctx) {
-    Value val = eval(*node.children[0], scope, ctx);
+    if (node.selfAppend) return evalSelfAppend(node, scope, ctx);
+
+    Value val = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
 
     if (node.nameParts.size() == 1) {
         // Simple: set x 5
-        uint32_t sym = interner_.intern(node.nameParts[0]);
-        scope->set(sym, val);
+        scope.set(node.nameIds[0], val);
     } else {
         // Dotted: set a.b.c 5
         // Look up root, navigate to penultimate map, set field on it
-        uint32_t rootSym = interner_.intern(node.nameParts[0]);
-        Value* root = scope->lookup(rootSym);
+        Value* root = scope.lookup(node.nameIds[0]);
         if (!root) {
             throw ScriptError("Undefined variable '" + node.nameParts[0] + "'", node.loc);
         }
@@ -496,15 +574,14 @@ Value Evaluator::evalSet(const AstNode& node, std::shared_ptr<Scope> scope,
                 throw ScriptError("Cannot access field '" + node.nameParts[i] +
                     "' on " + current.typeName(), node.loc);
             }
-            uint32_t sym = interner_.intern(node.nameParts[i]);
-            current = current.asMap().get(sym);
+            current = current.asMap().get(node.nameIds[i], node.fieldCaches[i]);
         }
 
         if (!current.isMap()) {
             throw ScriptError("Cannot set field on " + current.typeName(), node.loc);
         }
-        uint32_t lastSym = interner_.intern(node.nameParts.back());
-        current.asMap().set(lastSym, val);
+        uint32_t lastSym = node.nameIds.back();
+        current.asMap().set(lastSym, val, node.fieldCaches.back());
         // Auto-detect methods: closures with first param named "self"
         if (isAutoMethod(val)) {
             current.asMap().markMethod(lastSym);
@@ -514,84 +591,120 @@ Value Evaluator::evalSet(const AstNode& node, std::shared_ptr<Scope> scope,
     return val;
 }
 
+Value Evaluator::evalSelfAppend(const AstNode& node, Scope& scope,
+                                 ExecutionContext* ctx) {
+    // set s (s + x) and set s "{s}...": the usual result, except that a
+    // string nothing else can see is extended in place, so building one up
+    // in a loop is linear
+    const AstNode& value = *node.children[0];
+    uint32_t sym = node.nameIds[0];
+    bool interp = value.kind == AstNodeKind::StringInterp;
+    const AstNode& head = *value.children[0];
+    Value left = evalName(interp ? *head.children[0] : head, scope);
+    if (interp && left.isCallable()) {
+        // {s} calls a function value: nothing to append to
+        Value val = evalStringInterp(value, scope, ctx);
+        if (unwinding()) return Value::nil();
+        scope.set(sym, val);
+        return val;
+    }
+    auto appendTo = [&](std::string_view suffix) {
+        Value* target = scope.lookup(sym);
+        return target && target->appendInPlace(left, suffix) ? target : nullptr;
+    };
+
+    Value val;
+    if (interp) {
+        std::string suffix = interpolate(value, 1, scope, ctx);
+        if (unwinding()) return Value::nil();
+        if (left.isString()) {
+            if (Value* target = appendTo(suffix)) return *target;
+            val = Value::string(left.asString() + suffix);
+        } else {
+            val = Value::string(left.toString(&interner_) + suffix);
+        }
+    } else {
+        Value right = evalOperand(*value.children[1], scope, ctx);
+        if (unwinding()) return Value::nil();
+        if (left.isString() && right.isString()) {
+            if (Value* target = appendTo(right.asString())) return *target;
+        }
+        val = applyBinOp(BinaryOp::Add, left, right, value.loc);
+    }
+    scope.set(sym, val);
+    return val;
+}
+
 // -- Let (local define) --
 
-Value Evaluator::evalLet(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalLet(const AstNode& node, Scope& scope,
                           ExecutionContext* ctx) {
-    Value val = eval(*node.children[0], scope, ctx);
-    uint32_t sym = interner_.intern(node.nameParts[0]);
-    scope->define(sym, val);
+    Value val = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
+    scope.define(node.nameIds[0], val);
     return val;
 }
 
 // -- Fn --
 
-Value Evaluator::evalFn(const AstNode& node, std::shared_ptr<Scope> scope) {
+Value Evaluator::evalFn(const AstNode& node, Scope& scope) {
+    auto closure = makeClosure(node, scope);
+    closure->astRoot = currentAstRoot_;  // keeps AST alive
+    Value closureVal = Value::closure(closure);
+
+    // Named function: define in current scope
+    if (node.symbolId != kNoSymbol) {
+        scope.define(node.symbolId, closureVal);
+    }
+
+    return closureVal;
+}
+
+std::shared_ptr<Closure> Evaluator::makeClosure(const AstNode& node, Scope& scope) {
     auto closure = std::make_shared<Closure>();
     closure->name = node.stringValue;
     closure->body = node.children[0].get();
-    closure->astRoot = currentAstRoot_;  // keeps AST alive
-    closure->capturedScope = scope;
+    closure->capturedScope = scope.capture(node.freeNames);
     closure->numRequired = static_cast<size_t>(node.intValue);
 
-    for (const auto& param : node.nameParts) {
-        closure->paramIds.push_back(interner_.intern(param));
-    }
+    closure->paramIds = node.nameIds;
 
     // Default expressions (children[1..] are defaults for optional params)
     for (size_t i = 1; i < node.children.size(); i++) {
         closure->defaultExprs.push_back(node.children[i].get());
     }
 
-    // Variadic params: op = "restName|kwargsName" (pipe-delimited)
-    if (!node.op.empty()) {
-        auto pipe = node.op.find('|');
-        if (pipe == std::string::npos) {
-            // rest only (no pipe)
-            closure->hasRestParam = true;
-            closure->restParamId = interner_.intern(node.op);
-        } else {
-            std::string restName = node.op.substr(0, pipe);
-            std::string kwargsName = node.op.substr(pipe + 1);
-            if (!restName.empty()) {
-                closure->hasRestParam = true;
-                closure->restParamId = interner_.intern(restName);
-            }
-            if (!kwargsName.empty()) {
-                closure->hasKwargsParam = true;
-                closure->kwargsParamId = interner_.intern(kwargsName);
-            }
-        }
+    // Variadic params
+    if (node.restId != kNoSymbol) {
+        closure->hasRestParam = true;
+        closure->restParamId = node.restId;
     }
-
-    Value closureVal = Value::closure(closure);
-
-    // Named function: define in current scope
-    if (!node.stringValue.empty()) {
-        uint32_t nameSym = interner_.intern(node.stringValue);
-        scope->define(nameSym, closureVal);
+    if (node.kwargsId != kNoSymbol) {
+        closure->hasKwargsParam = true;
+        closure->kwargsParamId = node.kwargsId;
     }
 
-    return closureVal;
+    return closure;
 }
 
 // -- If --
 
-Value Evaluator::evalIf(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalIf(const AstNode& node, Scope& scope,
                          ExecutionContext* ctx) {
     // children: [cond1, body1, cond2, body2, ...] with optional else body at end
     size_t numChildren = node.children.size();
     size_t pairs = node.hasElse ? (numChildren - 1) / 2 : numChildren / 2;
 
     for (size_t i = 0; i < pairs; i++) {
-        Value cond = eval(*node.children[i * 2], scope, ctx);
+        Value cond = evalNode(*node.children[i * 2], scope, ctx);
+        if (unwinding()) return Value::nil();
         if (cond.truthy()) {
-            return eval(*node.children[i * 2 + 1], scope, ctx);
+            return evalNode(*node.children[i * 2 + 1], scope, ctx);
         }
     }
 
     if (node.hasElse) {
-        return eval(*node.children.back(), scope, ctx);
+        return evalNode(*node.children.back(), scope, ctx);
     }
 
     return Value::nil();
@@ -599,60 +712,131 @@ Value Evaluator::evalIf(const AstNode& node, std::shared_ptr<Scope> scope,
 
 // -- For --
 
-Value Evaluator::evalFor(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalFor(const AstNode& node, Scope& scope,
                           ExecutionContext* ctx) {
-    uint32_t varSym = interner_.intern(node.nameParts[0]);
-    Value iterable = eval(*node.children[0], scope, ctx);
+    uint32_t varSym = node.nameIds[0];
+    uint32_t valueSym = node.nameIds.size() > 1 ? node.nameIds[1] : kNoSymbol;
+    Value iterable = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
 
-    auto loopScope = scope->createChild();
+    auto loopScope = scope.createFrame();
     loopScope->define(varSym, Value::nil());
+    if (valueSym != kNoSymbol) loopScope->define(valueSym, Value::nil());
 
     Value result;
 
-    if (iterable.isArray()) {
-        for (const auto& elem : iterable.asArray()) {
-            loopScope->define(varSym, elem);
-            result = eval(*node.children[1], loopScope, ctx);
+    if (valueSym == kNoSymbol) {
+        if (auto* range = iterable.lazyRange()) {
+            // Counting loop: no array is built. Bounds are fixed at loop entry.
+            for (int64_t i = range->start, end = range->end; i < end; i++) {
+                loopScope->define(varSym, Value::integer(i));
+                evalInto(result, *node.children[1], *loopScope, ctx);
+                if (unwinding()) break;
+            }
+            return result;
         }
-    } else {
+    }
+
+    if (iterable.isMap() && iterable.asMap().isProxy()) {
+        auto it = iterable.asMap().proxy()->iterate();
+        uint32_t key;
+        Value value;
+        while (it->next(key, value)) {
+            loopScope->define(varSym, Value::symbol(key));
+            if (valueSym != kNoSymbol) loopScope->define(valueSym, std::move(value));
+            evalInto(result, *node.children[1], *loopScope, ctx);
+            if (unwinding()) break;
+        }
+        return result;
+    }
+    if (!iterable.isArray() && !iterable.isString() && !iterable.isMap()) {
         throw ScriptError("Cannot iterate over " + iterable.typeName(), node.loc);
     }
 
+    Value value, key;
+    Value* keyOut = valueSym != kNoSymbol ? &key : nullptr;
+    for (size_t cursor = 0; forStep(iterable, cursor, value, keyOut);) {
+        if (keyOut) {
+            loopScope->define(varSym, key);
+            loopScope->define(valueSym, value);
+        } else {
+            loopScope->define(varSym, value);
+        }
+        evalInto(result, *node.children[1], *loopScope, ctx);
+        if (unwinding()) break;
+    }
+
     return result;
 }
 
+bool Evaluator::forStep(const Value& iterable, size_t& cursor, Value& value, Value* key) {
+    if (iterable.isMap()) {
+        uint32_t k;
+        if (!iterable.asMap().nextEntry(cursor, k, value)) return false;
+        if (key) {
+            *key = Value::symbol(k);
+        } else {
+            value = Value::symbol(k);
+        }
+        return true;
+    }
+    if (auto* range = iterable.lazyRange()) {
+        if (static_cast<int64_t>(cursor) >= range->size()) return false;
+        value = Value::integer(range->start + static_cast<int64_t>(cursor));
+    } else if (iterable.isArray()) {
+        const auto& arr = iterable.asArray();
+        if (cursor >= arr.size()) return false;
+        value = arr[cursor];
+    } else {
+        // Strings step by UTF-8 character; the index is its byte offset
+        const auto& str = iterable.asString();
+        if (cursor >= str.size()) return false;
+        size_t len = utf8CharLength(str, cursor);
+        value = Value::string(str.substr(cursor, len));
+        if (key) *key = Value::integer(static_cast<int64_t>(cursor));
+        cursor += len;
+        return true;
+    }
+    if (key) *key = Value::integer(static_cast<int64_t>(cursor));
+    cursor++;
+    return true;
+}
+
 // -- While --
 
-Value Evaluator::evalWhile(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalWhile(const AstNode& node, Scope& scope,
                             ExecutionContext* ctx) {
     Value result;
     while (true) {
-        Value cond = eval(*node.children[0], scope, ctx);
-        if (!cond.truthy()) break;
-        result = eval(*node.children[1], scope, ctx);
+        Value cond = evalNode(*node.children[0], scope, ctx);
+        if (unwinding() || !cond.truthy()) break;
+        evalInto(result, *node.children[1], scope, ctx);
+        if (unwinding()) break;
     }
     return result;
 }
 
 // -- Match --
 
-Value Evaluator::evalMatch(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalMatch(const AstNode& node, Scope& scope,
                             ExecutionContext* ctx) {
     // children[0] = scrutinee, then pairs: [pattern, body, pattern, body, ...]
-    Value scrutinee = eval(*node.children[0], scope, ctx);
+    Value scrutinee = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
 
     for (size_t i = 1; i + 1 < node.children.size(); i += 2) {
         auto& pattern = *node.children[i];
 
         // Wildcard: _ matches anything
         if (pattern.kind == AstNodeKind::Name && pattern.stringValue == "_") {
-            return eval(*node.children[i + 1], scope, ctx);
+            return evalNode(*node.children[i + 1], scope, ctx);
         }
 
         // Evaluate pattern and compare
-        Value patVal = eval(pattern, scope, ctx);
+        Value patVal = evalOperand(pattern, scope, ctx);
+        if (unwinding()) return Value::nil();
         if (scrutinee == patVal) {
-            return eval(*node.children[i + 1], scope, ctx);
+            return evalNode(*node.children[i + 1], scope, ctx);
         }
     }
 
@@ -661,7 +845,7 @@ Value Evaluator::evalMatch(const AstNode& node, std::shared_ptr<Scope> scope,
 
 // -- On --
 
-Value Evaluator::evalOn(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalOn(const AstNode& node, Scope& scope,
                          ExecutionContext* ctx) {
     if (!ctx) {
         throw ScriptError("'on' requires an execution context", node.loc);
@@ -671,35 +855,38 @@ Value Evaluator::evalOn(const AstNode& node, std::shared_ptr<Scope> scope,
     closure->name = "on:" + node.stringValue;
     closure->body = node.children[0].get();
     closure->astRoot = currentAstRoot_;  // keeps AST alive
-    closure->capturedScope = scope;
+    closure->capturedScope = scope.shared_from_this();
 
     Value handlerVal = Value::closure(closure);
-    uint32_t eventSym = interner_.intern(node.stringValue);
-    ctx->registerEventHandler(eventSym, handlerVal);
+    ctx->registerEventHandler(node.symbolId, handlerVal);
 
     return Value::nil();
 }
 
 // -- Return --
 
-Value Evaluator::evalReturn(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalReturn(const AstNode& node, Scope& scope,
                               ExecutionContext* ctx) {
     Value val;
     if (!node.children.empty()) {
-        val = eval(*node.children[0], scope, ctx);
+        val = evalNode(*node.children[0], scope, ctx);
+        if (unwinding()) return Value::nil();
     }
-    throw ReturnSignal(std::move(val));
+    completion_ = Completion::Return;
+    completionValue_ = std::move(val);
+    return Value::nil();
 }
 
 // -- Source --
 
-Value Evaluator::evalSource(const AstNode& node, std::shared_ptr<Scope> scope,
+Value Evaluator::evalSource(const AstNode& node, Scope& scope,
                               ExecutionContext* ctx) {
     if (!engine_) {
         throw ScriptError("'source' not available (no ScriptEngine configured)", node.loc);
     }
 
-    Value filenameVal = eval(*node.children[0], scope, ctx);
+    Value filenameVal = evalNode(*node.children[0], scope, ctx);
+    if (unwinding()) return Value::nil();
     if (!filenameVal.isString()) {
         throw ScriptError("source requires a string filename", node.loc);
     }
@@ -709,24 +896,27 @@ Value Evaluator::evalSource(const AstNode& node, std::shared_ptr<Scope> scope,
         throw ScriptError("Cannot resolve script: " + filenameVal.asString(), node.loc);
     }
     auto* compiled = engine_->loadScript(resolved);
+    if (compiled->root->boundInterner != &interner_) bindSymbols(*compiled->root, interner_);
 
     // Execute in the current scope (like bash source)
-    auto prevRoot = currentAstRoot_;
-    currentAstRoot_ = compiled->root;
-    Value result = eval(*compiled->root, scope, ctx);
-    currentAstRoot_ = prevRoot;
-    return result;
+    AstRootGuard guard(currentAstRoot_, compiled->root);
+    return evalNode(*compiled->root, scope, ctx);
 }
 
 // -- Function calling --
 
-Value Evaluator::callFunction(const Value& callable, std::vector<Value> args,
-                               std::shared_ptr<Scope> scope, ExecutionContext* ctx,
+Value Evaluator::callFunction(const Value& callable, ArgSpan args,
+                               std::shared_ptr<Scope> /*scope*/, ExecutionContext* ctx,
                                SourceLocation callSite) {
+    return invoke(callable, args, ctx, callSite);
+}
+
+Value Evaluator::invoke(const Value& callable, ArgSpan args,
+                        ExecutionContext* ctx, SourceLocation callSite) {
     if (callable.isClosure()) {
         // const_cast safe: we need non-const access to the closure's internals
         auto& closure = const_cast<Value&>(callable).asClosure();
-        return callClosure(closure, std::move(args), ctx, callSite);
+        return callClosure(closure, args, ctx, callSite);
     }
 
     if (callable.isNativeFunction()) {
@@ -740,9 +930,11 @@ Value Evaluator::callFunction(const Value& callable, std::vector<Value> args,
     throw ScriptError("Value is not callable: " + callable.typeName(), callSite);
 }
 
-Value Evaluator::callClosure(Closure& closure, std::vector<Value> args,
+Value Evaluator::callClosure(Closure& closure, ArgSpan args,
                               ExecutionContext* ctx, SourceLocation /*callSite*/) {
-    auto callScope = closure.capturedScope->createChild();
+    // Compiled bodies get a call scope with slots for their locals
+    auto callScope = closure.capturedScope->createFrame(
+        closure.chunk ? closure.chunk->layout : nullptr);
 
     // Bind parameters (with default support)
     for (size_t i = 0; i < closure.paramIds.size(); i++) {
@@ -752,7 +944,9 @@ Value Evaluator::callClosure(Closure& closure, std::vector<Value> args,
                    (i - closure.numRequired) < closure.defaultExprs.size() &&
                    closure.defaultExprs[i - closure.numRequired] != nullptr) {
             // Evaluate default expression at call time
-            Value def = eval(*closure.defaultExprs[i - closure.numRequired], callScope, ctx);
+            Value def = evalNode(*closure.defaultExprs[i - closure.numRequired], *callScope, ctx);
+            // A `return` here completes the call, whichever tier runs the body
+            if (unwinding()) return takeReturn(std::move(def));
             callScope->define(closure.paramIds[i], def);
         } else {
             callScope->define(closure.paramIds[i], Value::nil());
@@ -772,18 +966,22 @@ Value Evaluator::callClosure(Closure& closure, std::vector<Value> args,
         callScope->define(closure.kwargsParamId, Value::map());
     }
 
-    // Evaluate body, catching ReturnSignal at function boundary
-    try {
-        return eval(*closure.body, callScope, ctx);
-    } catch (ReturnSignal& sig) {
-        return std::move(sig.value());
+    // Compiled bodies return without unwinding
+    if (closure.chunk) {
+        bool returned = false;
+        return runFrame(*closure.chunk, std::move(callScope), ctx, returned);
     }
+
+    // A `return` in the body completes the call
+    return takeReturn(evalNode(*closure.body, *callScope, ctx));
 }
 
-Value Evaluator::callClosureWithNamed(Closure& closure, std::vector<Value> posArgs,
+Value Evaluator::callClosureWithNamed(Closure& closure, ArgSpan posArgs,
                                        std::vector<std::pair<uint32_t, Value>> namedArgs,
                                        ExecutionContext* ctx, SourceLocation /*callSite*/) {
-    auto callScope = closure.capturedScope->createChild();
+    // Compiled bodies get a call scope with slots for their locals
+    auto callScope = closure.capturedScope->createFrame(
+        closure.chunk ? closure.chunk->layout : nullptr);
 
     // Track which named args get matched to regular params
     std::vector<bool> namedArgUsed(namedArgs.size(), false);
@@ -808,7 +1006,8 @@ Value Evaluator::callClosureWithNamed(Closure& closure, std::vector<Value> posAr
                 if (i >= closure.numRequired &&
                     (i - closure.numRequired) < closure.defaultExprs.size() &&
                     closure.defaultExprs[i - closure.numRequired] != nullptr) {
-                    Value def = eval(*closure.defaultExprs[i - closure.numRequired], callScope, ctx);
+                    Value def = evalNode(*closure.defaultExprs[i - closure.numRequired], *callScope, ctx);
+                    if (unwinding()) return takeReturn(std::move(def));
                     callScope->define(closure.paramIds[i], def);
                 } else {
                     callScope->define(closure.paramIds[i], Value::nil());
@@ -837,498 +1036,562 @@ Value Evaluator::callClosureWithNamed(Closure& closure, std::vector<Value> posAr
         callScope->define(closure.kwargsParamId, kwargsMap);
     }
 
-    try {
-        return eval(*closure.body, callScope, ctx);
-    } catch (ReturnSignal& sig) {
-        return std::move(sig.value());
+    if (closure.chunk) {
+        bool returned = false;
+        return runFrame(*closure.chunk, std::move(callScope), ctx, returned);
     }
+
+    return takeReturn(evalNode(*closure.body, *callScope, ctx));
 }
 
-// -- Built-in method dispatch --
+// -- Built-in methods --
 
-bool Evaluator::isBuiltinMapMethod(uint32_t sym) const {
-    return sym == sym_get_ || sym == sym_set_ || sym == sym_has_ ||
-           sym == sym_remove_ || sym == sym_keys_ || sym == sym_values_ ||
-           sym == sym_setMethod_;
+const Method* Evaluator::findMethod(const Value& receiver, uint32_t sym) const {
+    return methods_[static_cast<size_t>(receiver.type())].find(sym);
 }
 
-bool Evaluator::isBuiltinArrayMethod(uint32_t sym) const {
-    return sym == sym_length_ || sym == sym_push_ || sym == sym_pop_ ||
-           sym == sym_get_ || sym == sym_set_ || sym == sym_slice_ ||
-           sym == sym_contains_ || sym == sym_sort_ || sym == sym_sort_by_ ||
-           sym == sym_map_ || sym == sym_filter_ || sym == sym_foreach_;
+Value Evaluator::invokeMethod(const Method& method, const Value& self, ArgSpan args,
+                              ExecutionContext* ctx, SourceLocation loc) {
+    if (method.fn) return method.fn(*this, self, args, ctx, loc);
+    ArgBuffer withSelf;
+    withSelf.push_back(self);
+    for (const auto& a : args) withSelf.push_back(a);
+    return invoke(method.function, withSelf, ctx, loc);
 }
 
-bool Evaluator::isBuiltinStringMethod(uint32_t sym) const {
-    return sym == sym_length_ || sym == sym_get_ || sym == sym_set_ ||
-           sym == sym_char_at_ || sym == sym_insert_ || sym == sym_delete_ ||
-           sym == sym_replace_ || sym == sym_find_ || sym == sym_contains_ ||
-           sym == sym_substr_ || sym == sym_slice_ || sym == sym_split_ ||
-           sym == sym_upper_ || sym == sym_lower_ || sym == sym_trim_ ||
-           sym == sym_starts_with_ || sym == sym_ends_with_ || sym == sym_push_;
+void Evaluator::setMethod(Value::Type type, uint32_t sym, MethodFn fn) {
+    methods_[static_cast<size_t>(type)].set(sym, Method{fn, Value()});
 }
 
-Value Evaluator::dispatchBuiltinMethod(const Value& object, uint32_t methodSym,
-                                        std::vector<Value> args, std::shared_ptr<Scope> scope,
-                                        ExecutionContext* ctx, SourceLocation loc) {
-    // -- Map built-in methods --
-    if (object.isMap()) {
-        MapData& map = const_cast<Value&>(object).asMap();
-
-        if (methodSym == sym_get_) {
-            if (args.empty()) throw ScriptError("map.get requires a key argument", loc);
-            if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
-            return map.get(args[0].asSymbol());
-        }
-        if (methodSym == sym_set_) {
-            if (args.size() < 2) throw ScriptError("map.set requires key and value arguments", loc);
-            if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
-            uint32_t key = args[0].asSymbol();
-            map.set(key, args[1]);
-            // Auto-detect methods: closures with first param named "self"
-            if (isAutoMethod(args[1])) {
-                map.markMethod(key);
-            }
-            return args[1];
-        }
-        if (methodSym == sym_has_) {
-            if (args.empty()) throw ScriptError("map.has requires a key argument", loc);
-            if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
-            return Value::boolean(map.has(args[0].asSymbol()));
-        }
-        if (methodSym == sym_remove_) {
-            if (args.empty()) throw ScriptError("map.remove requires a key argument", loc);
-            if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
-            return Value::boolean(map.remove(args[0].asSymbol()));
-        }
-        if (methodSym == sym_keys_) {
-            auto keys = map.keys();
-            std::vector<Value> result;
-            result.reserve(keys.size());
-            for (uint32_t k : keys) {
-                result.push_back(Value::symbol(k));
-            }
-            return Value::array(std::move(result));
-        }
-        if (methodSym == sym_values_) {
-            auto keys = map.keys();
-            std::vector<Value> result;
-            result.reserve(keys.size());
-            for (uint32_t k : keys) {
-                result.push_back(map.get(k));
-            }
-            return Value::array(std::move(result));
-        }
-        if (methodSym == sym_setMethod_) {
-            if (args.size() < 2) throw ScriptError("map.setMethod requires name and function arguments", loc);
-            if (!args[0].isSymbol()) throw ScriptError("Method name must be a symbol", loc);
-            map.setMethod(args[0].asSymbol(), args[1]);
-            return args[1];
-        }
-    }
-
-    // -- Array built-in methods --
-    if (object.isArray()) {
-        auto& arr = const_cast<Value&>(object).asArrayMut();
+void Evaluator::setMethod(Value::Type type, uint32_t sym, Value function) {
+    if (!function.isCallable()) throw std::invalid_argument("Evaluator::setMethod: not callable");
+    methods_[static_cast<size_t>(type)].set(sym, Method{nullptr, std::move(function)});
+}
 
-        if (methodSym == sym_length_) {
-            return Value::integer(static_cast<int64_t>(arr.size()));
-        }
-        if (methodSym == sym_push_) {
-            for (auto& a : args) {
-                arr.push_back(a);
-            }
-            return Value::integer(static_cast<int64_t>(arr.size()));
+void Evaluator::initMethodTables() {
+    using B = BuiltinSymbol;
+    using T = Value::Type;
+    auto def = [this](T type, B symbol, MethodFn fn) { setMethod(type, builtinId(symbol), fn); };
+
+    // -- Map --
+    def(T::Map, B::Get, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("map.get requires a key argument", loc);
+        if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
+        return self.asMap().get(args[0].asSymbol());
+    });
+    def(T::Map, B::Set, [](Evaluator& ev, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.size() < 2) throw ScriptError("map.set requires key and value arguments", loc);
+        if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
+        MapData& map = const_cast<Value&>(self).asMap();
+        uint32_t key = args[0].asSymbol();
+        map.set(key, args[1]);
+        // Auto-detect methods: closures with first param named "self"
+        if (ev.isAutoMethod(args[1])) {
+            map.markMethod(key);
+        }
+        return args[1];
+    });
+    def(T::Map, B::Has, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("map.has requires a key argument", loc);
+        if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
+        return Value::boolean(self.asMap().has(args[0].asSymbol()));
+    });
+    def(T::Map, B::Remove, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("map.remove requires a key argument", loc);
+        if (!args[0].isSymbol()) throw ScriptError("Map key must be a symbol", loc);
+        return Value::boolean(const_cast<Value&>(self).asMap().remove(args[0].asSymbol()));
+    });
+    def(T::Map, B::Keys, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        return mapKeys(self.asMap());
+    });
+    def(T::Map, B::Values, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        return Value::array(self.asMap().values());
+    });
+    def(T::Map, B::SetMethod, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.size() < 2) throw ScriptError("map.setMethod requires name and function arguments", loc);
+        if (!args[0].isSymbol()) throw ScriptError("Method name must be a symbol", loc);
+        const_cast<Value&>(self).asMap().setMethod(args[0].asSymbol(), args[1]);
+        return args[1];
+    });
+
+    // -- Array (lazy ranges answer the read-only methods without materializing) --
+    def(T::Array, B::Length, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        if (auto* range = self.lazyRange()) return Value::integer(range->size());
+        return Value::integer(static_cast<int64_t>(self.asArray().size()));
+    });
+    def(T::Array, B::Push, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation) -> Value {
+        auto& arr = const_cast<Value&>(self).asArrayMut();
+        for (auto& a : args) {
+            arr.push_back(a);
+        }
+        return Value::integer(static_cast<int64_t>(arr.size()));
+    });
+    def(T::Array, B::Pop, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation loc) -> Value {
+        auto& arr = const_cast<Value&>(self).asArrayMut();
+        if (arr.empty()) throw ScriptError("Cannot pop from empty array", loc);
+        Value last = arr.back();
+        arr.pop_back();
+        return last;
+    });
+    def(T::Array, B::Get, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("array.get requires an index", loc);
+        if (!args[0].isInt()) throw ScriptError("Array index must be an integer", loc);
+        int64_t idx = args[0].asInt();
+        if (auto* range = self.lazyRange()) {
+            int64_t size = range->size();
+            if (idx < 0) idx += size;
+            if (idx < 0 || idx >= size) throw ScriptError("Array index out of bounds", loc);
+            return Value::integer(range->start + idx);
+        }
+        auto& arr = self.asArray();
+        if (idx < 0) idx += static_cast<int64_t>(arr.size());
+        if (idx < 0 || idx >= static_cast<int64_t>(arr.size())) {
+            throw ScriptError("Array index out of bounds", loc);
         }
-        if (methodSym == sym_pop_) {
-            if (arr.empty()) throw ScriptError("Cannot pop from empty array", loc);
-            Value last = arr.back();
-            arr.pop_back();
-            return last;
+        return arr[static_cast<size_t>(idx)];
+    });
+    def(T::Array, B::Set, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.size() < 2) throw ScriptError("array.set requires index and value", loc);
+        if (!args[0].isInt()) throw ScriptError("Array index must be an integer", loc);
+        auto& arr = const_cast<Value&>(self).asArrayMut();
+        int64_t idx = args[0].asInt();
+        if (idx < 0) idx += static_cast<int64_t>(arr.size());
+        if (idx < 0 || idx >= static_cast<int64_t>(arr.size())) {
+            throw ScriptError("Array index out of bounds", loc);
+        }
+        arr[static_cast<size_t>(idx)] = args[1];
+        return args[1];
+    });
+    def(T::Array, B::Slice, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("array.slice requires start index", loc);
+        if (!args[0].isInt()) throw ScriptError("Slice start must be an integer", loc);
+        auto* range = self.lazyRange();
+        int64_t size = range ? range->size() : static_cast<int64_t>(self.asArray().size());
+        int64_t start = args[0].asInt();
+        int64_t end = size;
+        if (args.size() > 1 && args[1].isInt()) end = args[1].asInt();
+        if (start < 0) start += size;
+        if (end < 0) end += size;
+        start = std::max(int64_t(0), std::min(start, size));
+        end = std::max(int64_t(0), std::min(end, size));
+        if (start > end) start = end;
+        if (range) return Value::range(range->start + start, range->start + end);
+        auto& arr = self.asArray();
+        std::vector<Value> result(arr.begin() + start, arr.begin() + end);
+        return Value::array(std::move(result));
+    });
+    def(T::Array, B::Contains, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("array.contains requires a value", loc);
+        if (auto* range = self.lazyRange()) {
+            return Value::boolean(args[0].isInt() && args[0].asInt() >= range->start &&
+                                  args[0].asInt() < range->end);
+        }
+        for (const auto& elem : self.asArray()) {
+            if (elem == args[0]) return Value::boolean(true);
+        }
+        return Value::boolean(false);
+    });
+    def(T::Array, B::Sort, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        auto& arr = const_cast<Value&>(self).asArrayMut();
+        std::sort(arr.begin(), arr.end(), [](const Value& a, const Value& b) {
+            if (a.isInt() && b.isInt()) return a.asInt() < b.asInt();
+            if (a.isNumeric() && b.isNumeric()) return a.asNumber() < b.asNumber();
+            if (a.isString() && b.isString()) return a.asString() < b.asString();
+            return false;
+        });
+        return self;
+    });
+    def(T::Array, B::SortBy, [](Evaluator& ev, const Value& self, ArgSpan args, ExecutionContext* ctx, SourceLocation loc) -> Value {
+        if (args.empty() || !args[0].isCallable()) {
+            throw ScriptError("array.sort_by requires a comparator function", loc);
+        }
+        auto& arr = const_cast<Value&>(self).asArrayMut();
+        auto& comparator = args[0];
+        std::sort(arr.begin(), arr.end(), [&](const Value& a, const Value& b) {
+            Value result = ev.invoke(comparator, {a, b}, ctx, loc);
+            return result.truthy();
+        });
+        return self;
+    });
+    def(T::Array, B::Map, [](Evaluator& ev, const Value& self, ArgSpan args, ExecutionContext* ctx, SourceLocation loc) -> Value {
+        if (args.empty() || !args[0].isCallable()) {
+            throw ScriptError("array.map requires a function argument", loc);
         }
-        if (methodSym == sym_get_) {
-            if (args.empty()) throw ScriptError("array.get requires an index", loc);
-            if (!args[0].isInt()) throw ScriptError("Array index must be an integer", loc);
-            int64_t idx = args[0].asInt();
-            if (idx < 0) idx += static_cast<int64_t>(arr.size());
-            if (idx < 0 || idx >= static_cast<int64_t>(arr.size())) {
-                throw ScriptError("Array index out of bounds", loc);
-            }
-            return arr[static_cast<size_t>(idx)];
-        }
-        if (methodSym == sym_set_) {
-            if (args.size() < 2) throw ScriptError("array.set requires index and value", loc);
-            if (!args[0].isInt()) throw ScriptError("Array index must be an integer", loc);
-            int64_t idx = args[0].asInt();
-            if (idx < 0) idx += static_cast<int64_t>(arr.size());
-            if (idx < 0 || idx >= static_cast<int64_t>(arr.size())) {
-                throw ScriptError("Array index out of bounds", loc);
+        std::vector<Value> result;
+        if (auto* range = self.lazyRange()) {
+            result.reserve(static_cast<size_t>(range->size()));
+            for (int64_t i = range->start; i < range->end; i++) {
+                result.push_back(ev.invoke(args[0], {Value::integer(i)}, ctx, loc));
             }
-            arr[static_cast<size_t>(idx)] = args[1];
-            return args[1];
-        }
-        if (methodSym == sym_slice_) {
-            if (args.empty()) throw ScriptError("array.slice requires start index", loc);
-            if (!args[0].isInt()) throw ScriptError("Slice start must be an integer", loc);
-            int64_t start = args[0].asInt();
-            int64_t end = static_cast<int64_t>(arr.size());
-            if (args.size() > 1 && args[1].isInt()) end = args[1].asInt();
-            if (start < 0) start += static_cast<int64_t>(arr.size());
-            if (end < 0) end += static_cast<int64_t>(arr.size());
-            start = std::max(int64_t(0), std::min(start, static_cast<int64_t>(arr.size())));
-            end = std::max(int64_t(0), std::min(end, static_cast<int64_t>(arr.size())));
-            if (start > end) start = end;
-            std::vector<Value> result(arr.begin() + start, arr.begin() + end);
             return Value::array(std::move(result));
         }
-        if (methodSym == sym_contains_) {
-            if (args.empty()) throw ScriptError("array.contains requires a value", loc);
-            for (const auto& elem : arr) {
-                if (elem == args[0]) return Value::boolean(true);
-            }
-            return Value::boolean(false);
-        }
-        if (methodSym == sym_sort_) {
-            std::sort(arr.begin(), arr.end(), [](const Value& a, const Value& b) {
-                if (a.isInt() && b.isInt()) return a.asInt() < b.asInt();
-                if (a.isNumeric() && b.isNumeric()) return a.asNumber() < b.asNumber();
-                if (a.isString() && b.isString()) return a.asString() < b.asString();
-                return false;
-            });
-            return object;
-        }
-        if (methodSym == sym_sort_by_) {
-            if (args.empty() || !args[0].isCallable()) {
-                throw ScriptError("array.sort_by requires a comparator function", loc);
-            }
-            auto& comparator = args[0];
-            std::sort(arr.begin(), arr.end(), [&](const Value& a, const Value& b) {
-                Value result = callFunction(comparator, {a, b}, scope, ctx, loc);
-                return result.truthy();
-            });
-            return object;
-        }
-        if (methodSym == sym_map_) {
-            if (args.empty() || !args[0].isCallable()) {
-                throw ScriptError("array.map requires a function argument", loc);
-            }
-            std::vector<Value> result;
-            result.reserve(arr.size());
-            for (const auto& elem : arr) {
-                result.push_back(callFunction(args[0], {elem}, scope, ctx, loc));
-            }
-            return Value::array(std::move(result));
+        auto& arr = self.asArray();
+        result.reserve(arr.size());
+        for (const auto& elem : arr) {
+            result.push_back(ev.invoke(args[0], {elem}, ctx, loc));
         }
-        if (methodSym == sym_filter_) {
-            if (args.empty() || !args[0].isCallable()) {
-                throw ScriptError("array.filter requires a function argument", loc);
-            }
-            std::vector<Value> result;
-            for (const auto& elem : arr) {
-                Value keep = callFunction(args[0], {elem}, scope, ctx, loc);
-                if (keep.truthy()) result.push_back(elem);
+        return Value::array(std::move(result));
+    });
+    def(T::Array, B::Filter, [](Evaluator& ev, const Value& self, ArgSpan args, ExecutionContext* ctx, SourceLocation loc) -> Value {
+        if (args.empty() || !args[0].isCallable()) {
+            throw ScriptError("array.filter requires a function argument", loc);
+        }
+        std::vector<Value> result;
+        if (auto* range = self.lazyRange()) {
+            for (int64_t i = range->start; i < range->end; i++) {
+                Value elem = Value::integer(i);
+                if (ev.invoke(args[0], {elem}, ctx, loc).truthy()) {
+                    result.push_back(std::move(elem));
+                }
             }
             return Value::array(std::move(result));
         }
-        if (methodSym == sym_foreach_) {
-            if (args.empty() || !args[0].isCallable()) {
-                throw ScriptError("array.foreach requires a function argument", loc);
-            }
-            for (const auto& elem : arr) {
-                callFunction(args[0], {elem}, scope, ctx, loc);
+        for (const auto& elem : self.asArray()) {
+            Value keep = ev.invoke(args[0], {elem}, ctx, loc);
+            if (keep.truthy()) result.push_back(elem);
+        }
+        return Value::array(std::move(result));
+    });
+    def(T::Array, B::Foreach, [](Evaluator& ev, const Value& self, ArgSpan args, ExecutionContext* ctx, SourceLocation loc) -> Value {
+        if (args.empty() || !args[0].isCallable()) {
+            throw ScriptError("array.foreach requires a function argument", loc);
+        }
+        if (auto* range = self.lazyRange()) {
+            for (int64_t i = range->start; i < range->end; i++) {
+                ev.invoke(args[0], {Value::integer(i)}, ctx, loc);
             }
             return Value::nil();
         }
-    }
-
-    // -- String built-in methods --
-    if (object.isString()) {
-        std::string& str = const_cast<Value&>(object).asStringMut();
-
-        if (methodSym == sym_length_) {
-            return Value::integer(static_cast<int64_t>(str.size()));
-        }
-        if (methodSym == sym_get_ || methodSym == sym_char_at_) {
-            if (args.empty()) throw ScriptError("string.get requires an index", loc);
-            if (!args[0].isInt()) throw ScriptError("String index must be an integer", loc);
-            int64_t idx = args[0].asInt();
-            if (idx < 0) idx += static_cast<int64_t>(str.size());
-            if (idx < 0 || idx >= static_cast<int64_t>(str.size())) {
-                throw ScriptError("String index out of bounds", loc);
-            }
-            return Value::string(std::string(1, str[static_cast<size_t>(idx)]));
-        }
-        if (methodSym == sym_set_) {
-            if (args.size() < 2) throw ScriptError("string.set requires index and character", loc);
-            if (!args[0].isInt()) throw ScriptError("String index must be an integer", loc);
-            if (!args[1].isString()) throw ScriptError("string.set value must be a string", loc);
-            int64_t idx = args[0].asInt();
-            if (idx < 0) idx += static_cast<int64_t>(str.size());
-            if (idx < 0 || idx >= static_cast<int64_t>(str.size())) {
-                throw ScriptError("String index out of bounds", loc);
-            }
-            const auto& replacement = args[1].asString();
-            str.replace(static_cast<size_t>(idx), 1, replacement);
-            return object;
-        }
-        if (methodSym == sym_push_) {
-            if (args.empty()) throw ScriptError("string.push requires a string argument", loc);
-            if (!args[0].isString()) throw ScriptError("string.push argument must be a string", loc);
-            str += args[0].asString();
-            return object;
-        }
-        if (methodSym == sym_insert_) {
-            if (args.size() < 2) throw ScriptError("string.insert requires index and string", loc);
-            if (!args[0].isInt()) throw ScriptError("Insert index must be an integer", loc);
-            if (!args[1].isString()) throw ScriptError("Insert value must be a string", loc);
-            int64_t idx = args[0].asInt();
-            if (idx < 0) idx += static_cast<int64_t>(str.size());
-            if (idx < 0 || idx > static_cast<int64_t>(str.size())) {
-                throw ScriptError("String insert index out of bounds", loc);
-            }
-            str.insert(static_cast<size_t>(idx), args[1].asString());
-            return object;
-        }
-        if (methodSym == sym_delete_) {
-            if (args.empty()) throw ScriptError("string.delete requires a start index", loc);
-            if (!args[0].isInt()) throw ScriptError("Delete start must be an integer", loc);
-            int64_t start = args[0].asInt();
-            if (start < 0) start += static_cast<int64_t>(str.size());
-            if (start < 0 || start >= static_cast<int64_t>(str.size())) {
-                throw ScriptError("String delete index out of bounds", loc);
-            }
-            size_t count = 1;
-            if (args.size() > 1 && args[1].isInt()) {
-                count = static_cast<size_t>(args[1].asInt());
-            }
-            str.erase(static_cast<size_t>(start), count);
-            return object;
+        for (const auto& elem : self.asArray()) {
+            ev.invoke(args[0], {elem}, ctx, loc);
+        }
+        return Value::nil();
+    });
+
+    // -- String (mutators write through asStringMut(), which copies a shared string first) --
+    def(T::String, B::Length, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        return Value::integer(static_cast<int64_t>(self.asString().size()));
+    });
+    MethodFn charAt = [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        const std::string& str = self.asString();
+        if (args.empty()) throw ScriptError("string.get requires an index", loc);
+        if (!args[0].isInt()) throw ScriptError("String index must be an integer", loc);
+        int64_t idx = args[0].asInt();
+        if (idx < 0) idx += static_cast<int64_t>(str.size());
+        if (idx < 0 || idx >= static_cast<int64_t>(str.size())) {
+            throw ScriptError("String index out of bounds", loc);
         }
-        if (methodSym == sym_replace_) {
-            if (args.size() < 2) throw ScriptError("string.replace requires old and new strings", loc);
-            if (!args[0].isString() || !args[1].isString()) {
-                throw ScriptError("string.replace arguments must be strings", loc);
+        return Value::string(std::string(1, str[static_cast<size_t>(idx)]));
+    };
+    def(T::String, B::Get, charAt);
+    def(T::String, B::CharAt, charAt);
+    def(T::String, B::Set, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.size() < 2) throw ScriptError("string.set requires index and character", loc);
+        if (!args[0].isInt()) throw ScriptError("String index must be an integer", loc);
+        if (!args[1].isString()) throw ScriptError("string.set value must be a string", loc);
+        int64_t size = static_cast<int64_t>(self.asString().size());
+        int64_t idx = args[0].asInt();
+        if (idx < 0) idx += size;
+        if (idx < 0 || idx >= size) {
+            throw ScriptError("String index out of bounds", loc);
+        }
+        const auto& replacement = args[1].asString();
+        const_cast<Value&>(self).asStringMut().replace(static_cast<size_t>(idx), 1, replacement);
+        return self;
+    });
+    def(T::String, B::Push, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.push requires a string argument", loc);
+        if (!args[0].isString()) throw ScriptError("string.push argument must be a string", loc);
+        const_cast<Value&>(self).asStringMut() += args[0].asString();
+        return self;
+    });
+    def(T::String, B::Insert, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.size() < 2) throw ScriptError("string.insert requires index and string", loc);
+        if (!args[0].isInt()) throw ScriptError("Insert index must be an integer", loc);
+        if (!args[1].isString()) throw ScriptError("Insert value must be a string", loc);
+        int64_t size = static_cast<int64_t>(self.asString().size());
+        int64_t idx = args[0].asInt();
+        if (idx < 0) idx += size;
+        if (idx < 0 || idx > size) {
+            throw ScriptError("String insert index out of bounds", loc);
+        }
+        const_cast<Value&>(self).asStringMut().insert(static_cast<size_t>(idx), args[1].asString());
+        return self;
+    });
+    def(T::String, B::Delete, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.delete requires a start index", loc);
+        if (!args[0].isInt()) throw ScriptError("Delete start must be an integer", loc);
+        int64_t size = static_cast<int64_t>(self.asString().size());
+        int64_t start = args[0].asInt();
+        if (start < 0) start += size;
+        if (start < 0 || start >= size) {
+            throw ScriptError("String delete index out of bounds", loc);
+        }
+        size_t count = 1;
+        if (args.size() > 1 && args[1].isInt()) {
+            count = static_cast<size_t>(args[1].asInt());
+        }
+        const_cast<Value&>(self).asStringMut().erase(static_cast<size_t>(start), count);
+        return self;
+    });
+    def(T::String, B::Replace, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.size() < 2) throw ScriptError("string.replace requires old and new strings", loc);
+        if (!args[0].isString() || !args[1].isString()) {
+            throw ScriptError("string.replace arguments must be strings", loc);
+        }
+        const auto& oldStr = args[0].asString();
+        const auto& newStr = args[1].asString();
+        if (oldStr.empty()) return self;
+        std::string& text = const_cast<Value&>(self).asStringMut();
+        size_t pos = 0;
+        while ((pos = text.find(oldStr, pos)) != std::string::npos) {
+            text.replace(pos, oldStr.size(), newStr);
+            pos += newStr.size();
+        }
+        return self;
+    });
+    def(T::String, B::Find, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.find requires a search string", loc);
+        if (!args[0].isString()) throw ScriptError("string.find argument must be a string", loc);
+        size_t start = 0;
+        if (args.size() > 1 && args[1].isInt()) {
+            start = static_cast<size_t>(args[1].asInt());
+        }
+        auto pos = self.asString().find(args[0].asString(), start);
+        if (pos == std::string::npos) return Value::integer(-1);
+        return Value::integer(static_cast<int64_t>(pos));
+    });
+    def(T::String, B::Contains, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.contains requires a search string", loc);
+        if (!args[0].isString()) throw ScriptError("string.contains argument must be a string", loc);
+        return Value::boolean(self.asString().find(args[0].asString()) != std::string::npos);
+    });
+    def(T::String, B::Substr, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.substr requires a start index", loc);
+        if (!args[0].isInt()) throw ScriptError("Substr start must be an integer", loc);
+        const std::string& str = self.asString();
+        int64_t start = args[0].asInt();
+        if (start < 0) start += static_cast<int64_t>(str.size());
+        if (start < 0) start = 0;
+        if (start >= static_cast<int64_t>(str.size())) return Value::string("");
+        if (args.size() > 1 && args[1].isInt()) {
+            auto len = static_cast<size_t>(args[1].asInt());
+            return Value::string(str.substr(static_cast<size_t>(start), len));
+        }
+        return Value::string(str.substr(static_cast<size_t>(start)));
+    });
+    def(T::String, B::Slice, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.slice requires a start index", loc);
+        if (!args[0].isInt()) throw ScriptError("Slice start must be an integer", loc);
+        const std::string& str = self.asString();
+        int64_t start = args[0].asInt();
+        int64_t end = static_cast<int64_t>(str.size());
+        if (args.size() > 1 && args[1].isInt()) end = args[1].asInt();
+        if (start < 0) start += static_cast<int64_t>(str.size());
+        if (end < 0) end += static_cast<int64_t>(str.size());
+        start = std::max(int64_t(0), std::min(start, static_cast<int64_t>(str.size())));
+        end = std::max(int64_t(0), std::min(end, static_cast<int64_t>(str.size())));
+        if (start > end) start = end;
+        return Value::string(str.substr(static_cast<size_t>(start),
+                                        static_cast<size_t>(end - start)));
+    });
+    def(T::String, B::Split, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.split requires a delimiter", loc);
+        if (!args[0].isString()) throw ScriptError("Split delimiter must be a string", loc);
+        const std::string& str = self.asString();
+        const auto& delim = args[0].asString();
+        std::vector<Value> parts;
+        if (delim.empty()) {
+            // Split into individual characters
+            for (char c : str) {
+                parts.push_back(Value::string(std::string(1, c)));
             }
-            const auto& oldStr = args[0].asString();
-            const auto& newStr = args[1].asString();
-            if (oldStr.empty()) return object;
+        } else {
             size_t pos = 0;
-            while ((pos = str.find(oldStr, pos)) != std::string::npos) {
-                str.replace(pos, oldStr.size(), newStr);
-                pos += newStr.size();
-            }
-            return object;
-        }
-        if (methodSym == sym_find_) {
-            if (args.empty()) throw ScriptError("string.find requires a search string", loc);
-            if (!args[0].isString()) throw ScriptError("string.find argument must be a string", loc);
-            size_t start = 0;
-            if (args.size() > 1 && args[1].isInt()) {
-                start = static_cast<size_t>(args[1].asInt());
-            }
-            auto pos = str.find(args[0].asString(), start);
-            if (pos == std::string::npos) return Value::integer(-1);
-            return Value::integer(static_cast<int64_t>(pos));
-        }
-        if (methodSym == sym_contains_) {
-            if (args.empty()) throw ScriptError("string.contains requires a search string", loc);
-            if (!args[0].isString()) throw ScriptError("string.contains argument must be a string", loc);
-            return Value::boolean(str.find(args[0].asString()) != std::string::npos);
-        }
-        if (methodSym == sym_substr_) {
-            if (args.empty()) throw ScriptError("string.substr requires a start index", loc);
-            if (!args[0].isInt()) throw ScriptError("Substr start must be an integer", loc);
-            int64_t start = args[0].asInt();
-            if (start < 0) start += static_cast<int64_t>(str.size());
-            if (start < 0) start = 0;
-            if (start >= static_cast<int64_t>(str.size())) return Value::string("");
-            if (args.size() > 1 && args[1].isInt()) {
-                auto len = static_cast<size_t>(args[1].asInt());
-                return Value::string(str.substr(static_cast<size_t>(start), len));
-            }
-            return Value::string(str.substr(static_cast<size_t>(start)));
-        }
-        if (methodSym == sym_slice_) {
-            if (args.empty()) throw ScriptError("string.slice requires a start index", loc);
-            if (!args[0].isInt()) throw ScriptError("Slice start must be an integer", loc);
-            int64_t start = args[0].asInt();
-            int64_t end = static_cast<int64_t>(str.size());
-            if (args.size() > 1 && args[1].isInt()) end = args[1].asInt();
-            if (start < 0) start += static_cast<int64_t>(str.size());
-            if (end < 0) end += static_cast<int64_t>(str.size());
-            start = std::max(int64_t(0), std::min(start, static_cast<int64_t>(str.size())));
-            end = std::max(int64_t(0), std::min(end, static_cast<int64_t>(str.size())));
-            if (start > end) start = end;
-            return Value::string(str.substr(static_cast<size_t>(start),
-                                            static_cast<size_t>(end - start)));
-        }
-        if (methodSym == sym_split_) {
-            if (args.empty()) throw ScriptError("string.split requires a delimiter", loc);
-            if (!args[0].isString()) throw ScriptError("Split delimiter must be a string", loc);
-            const auto& delim = args[0].asString();
-            std::vector<Value> parts;
-            if (delim.empty()) {
-                // Split into individual characters
-                for (char c : str) {
-                    parts.push_back(Value::string(std::string(1, c)));
-                }
-            } else {
-                size_t pos = 0;
-                size_t found;
-                while ((found = str.find(delim, pos)) != std::string::npos) {
-                    parts.push_back(Value::string(str.substr(pos, found - pos)));
-                    pos = found + delim.size();
-                }
-                parts.push_back(Value::string(str.substr(pos)));
+            size_t found;
+            while ((found = str.find(delim, pos)) != std::string::npos) {
+                parts.push_back(Value::string(str.substr(pos, found - pos)));
+                pos = found + delim.size();
             }
-            return Value::array(std::move(parts));
-        }
-        if (methodSym == sym_upper_) {
-            std::string result = str;
-            for (auto& c : result) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
-            return Value::string(std::move(result));
-        }
-        if (methodSym == sym_lower_) {
-            std::string result = str;
-            for (auto& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-            return Value::string(std::move(result));
-        }
-        if (methodSym == sym_trim_) {
-            size_t start = 0;
-            while (start < str.size() && std::isspace(static_cast<unsigned char>(str[start]))) start++;
-            size_t end = str.size();
-            while (end > start && std::isspace(static_cast<unsigned char>(str[end - 1]))) end--;
-            return Value::string(str.substr(start, end - start));
-        }
-        if (methodSym == sym_starts_with_) {
-            if (args.empty()) throw ScriptError("string.starts_with requires a string argument", loc);
-            if (!args[0].isString()) throw ScriptError("string.starts_with argument must be a string", loc);
-            const auto& prefix = args[0].asString();
-            return Value::boolean(str.size() >= prefix.size() &&
-                                  str.compare(0, prefix.size(), prefix) == 0);
-        }
-        if (methodSym == sym_ends_with_) {
-            if (args.empty()) throw ScriptError("string.ends_with requires a string argument", loc);
-            if (!args[0].isString()) throw ScriptError("string.ends_with argument must be a string", loc);
-            const auto& suffix = args[0].asString();
-            return Value::boolean(str.size() >= suffix.size() &&
-                                  str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0);
-        }
-    }
-
-    throw ScriptError("Unknown built-in method", loc);
+            parts.push_back(Value::string(str.substr(pos)));
+        }
+        return Value::array(std::move(parts));
+    });
+    def(T::String, B::Upper, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        std::string result = self.asString();
+        for (auto& c : result) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        return Value::string(std::move(result));
+    });
+    def(T::String, B::Lower, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        std::string result = self.asString();
+        for (auto& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return Value::string(std::move(result));
+    });
+    def(T::String, B::Trim, [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) -> Value {
+        const std::string& str = self.asString();
+        size_t start = 0;
+        while (start < str.size() && std::isspace(static_cast<unsigned char>(str[start]))) start++;
+        size_t end = str.size();
+        while (end > start && std::isspace(static_cast<unsigned char>(str[end - 1]))) end--;
+        return Value::string(str.substr(start, end - start));
+    });
+    def(T::String, B::StartsWith, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.starts_with requires a string argument", loc);
+        if (!args[0].isString()) throw ScriptError("string.starts_with argument must be a string", loc);
+        const std::string& str = self.asString();
+        const auto& prefix = args[0].asString();
+        return Value::boolean(str.size() >= prefix.size() &&
+                              str.compare(0, prefix.size(), prefix) == 0);
+    });
+    def(T::String, B::EndsWith, [](Evaluator&, const Value& self, ArgSpan args, ExecutionContext*, SourceLocation loc) -> Value {
+        if (args.empty()) throw ScriptError("string.ends_with requires a string argument", loc);
+        if (!args[0].isString()) throw ScriptError("string.ends_with argument must be a string", loc);
+        const std::string& str = self.asString();
+        const auto& suffix = args[0].asString();
+        return Value::boolean(str.size() >= suffix.size() &&
+                              str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0);
+    });
 }
 
 // -- Binary operator application --
 
-Value Evaluator::applyBinOp(const std::string& op, const Value& left, const Value& right,
+Value Evaluator::applyBinOp(BinaryOp op, const Value& left, const Value& right,
                              SourceLocation loc) {
-    // Range operators
-    if (op == "..") {
-        if (!left.isInt() || !right.isInt()) {
-            throw ScriptError("Range operands must be integers", loc);
-        }
-        int64_t start = left.asInt();
-        int64_t end = right.asInt();
-        std::vector<Value> range;
-        for (int64_t i = start; i < end; i++) {
-            range.push_back(Value::integer(i));
-        }
-        return Value::array(std::move(range));
-    }
-    if (op == "..=") {
-        if (!left.isInt() || !right.isInt()) {
-            throw ScriptError("Range operands must be integers", loc);
+    // Fast path: int op int
+    if (left.isInt() && right.isInt()) {
+        int64_t a = left.asInt();
+        int64_t b = right.asInt();
+        switch (op) {
+            case BinaryOp::Add: return Value::integer(a + b);
+            case BinaryOp::Sub: return Value::integer(a - b);
+            case BinaryOp::Mul: return Value::integer(a * b);
+            case BinaryOp::Div:
+                if (b == 0) throw ScriptError("Division by zero", loc);
+                return Value::integer(a / b); // truncating
+            case BinaryOp::Mod:
+                if (b == 0) throw ScriptError("Modulo by zero", loc);
+                return Value::integer(a % b);
+            case BinaryOp::Eq: return Value::boolean(a == b);
+            case BinaryOp::Ne: return Value::boolean(a != b);
+            case BinaryOp::Lt: return Value::boolean(a < b);
+            case BinaryOp::Gt: return Value::boolean(a > b);
+            case BinaryOp::Le: return Value::boolean(a <= b);
+            case BinaryOp::Ge: return Value::boolean(a >= b);
+            default: break;
         }
-        int64_t start = left.asInt();
-        int64_t end = right.asInt();
-        std::vector<Value> range;
-        for (int64_t i = start; i <= end; i++) {
-            range.push_back(Value::integer(i));
-        }
-        return Value::array(std::move(range));
     }
 
-    // Equality (works on all types)
-    if (op == "==") return Value::boolean(left == right);
-    if (op == "!=") return Value::boolean(left != right);
-
-    // String concatenation with +
-    if (op == "+" && left.isString() && right.isString()) {
-        return Value::string(left.asString() + right.asString());
-    }
-
-    // Array concatenation with +
-    if (op == "+" && left.isArray() && right.isArray()) {
-        auto& leftArr = left.asArray();
-        auto& rightArr = right.asArray();
-        std::vector<Value> result;
-        result.reserve(leftArr.size() + rightArr.size());
-        result.insert(result.end(), leftArr.begin(), leftArr.end());
-        result.insert(result.end(), rightArr.begin(), rightArr.end());
-        return Value::array(std::move(result));
+    // Fast path: float op float
+    if (left.isFloat() && right.isFloat()) {
+        double a = left.asFloat();
+        double b = right.asFloat();
+        switch (op) {
+            case BinaryOp::Add: return Value::number(a + b);
+            case BinaryOp::Sub: return Value::number(a - b);
+            case BinaryOp::Mul: return Value::number(a * b);
+            case BinaryOp::Div:
+                if (b == 0.0) throw ScriptError("Division by zero", loc);
+                return Value::number(a / b);
+            case BinaryOp::Mod:
+                if (b == 0.0) throw ScriptError("Modulo by zero", loc);
+                return Value::number(std::fmod(a, b));
+            case BinaryOp::Eq: return Value::boolean(a == b);
+            case BinaryOp::Ne: return Value::boolean(a != b);
+            case BinaryOp::Lt: return Value::boolean(a < b);
+            case BinaryOp::Gt: return Value::boolean(a > b);
+            case BinaryOp::Le: return Value::boolean(a <= b);
+            case BinaryOp::Ge: return Value::boolean(a >= b);
+            default: break;
+        }
     }
 
-    // String format with % (printf-style)
-    // Single value: "%.2f" % 3.14
-    // Multiple values: "%d/%d" % [10 20]
-    if (op == "%" && left.isString()) {
-        const auto& fmt = left.asString();
-        if (right.isArray()) {
-            return Value::string(formatMulti(fmt, right.asArray(), &interner_));
+    switch (op) {
+        // Range operators
+        case BinaryOp::Range:
+        case BinaryOp::RangeIncl: {
+            if (!left.isInt() || !right.isInt()) {
+                throw ScriptError("Range operands must be integers", loc);
+            }
+            int64_t start = left.asInt();
+            int64_t end = right.asInt();
+            if (op == BinaryOp::RangeIncl) end++;
+            return Value::range(start, end);
         }
-        // Single value — use formatMulti with a one-element vector
-        return Value::string(formatMulti(fmt, {right}, &interner_));
-    }
 
-    // Arithmetic and comparison (numeric)
-    if (left.isNumeric() && right.isNumeric()) {
-        bool useFloat = left.isFloat() || right.isFloat();
+        // Equality (works on all types)
+        case BinaryOp::Eq: return Value::boolean(left == right);
+        case BinaryOp::Ne: return Value::boolean(left != right);
 
-        if (op == "+") {
-            if (useFloat) return Value::number(left.asNumber() + right.asNumber());
-            return Value::integer(left.asInt() + right.asInt());
-        }
-        if (op == "-") {
-            if (useFloat) return Value::number(left.asNumber() - right.asNumber());
-            return Value::integer(left.asInt() - right.asInt());
-        }
-        if (op == "*") {
-            if (useFloat) return Value::number(left.asNumber() * right.asNumber());
-            return Value::integer(left.asInt() * right.asInt());
-        }
-        if (op == "/") {
-            if (useFloat) {
-                if (right.asNumber() == 0.0) throw ScriptError("Division by zero", loc);
-                return Value::number(left.asNumber() / right.asNumber());
+        case BinaryOp::Add:
+            // String concatenation with +
+            if (left.isString() && right.isString()) {
+                return Value::string(left.asString() + right.asString());
             }
-            if (right.asInt() == 0) throw ScriptError("Division by zero", loc);
-            return Value::integer(left.asInt() / right.asInt()); // truncating
-        }
-        if (op == "%") {
-            if (useFloat) {
-                if (right.asNumber() == 0.0) throw ScriptError("Modulo by zero", loc);
-                return Value::number(std::fmod(left.asNumber(), right.asNumber()));
+            // Array concatenation with +
+            if (left.isArray() && right.isArray()) {
+                auto& leftArr = left.asArray();
+                auto& rightArr = right.asArray();
+                std::vector<Value> result;
+                result.reserve(leftArr.size() + rightArr.size());
+                result.insert(result.end(), leftArr.begin(), leftArr.end());
+                result.insert(result.end(), rightArr.begin(), rightArr.end());
+                return Value::array(std::move(result));
             }
-            if (right.asInt() == 0) throw ScriptError("Modulo by zero", loc);
-            return Value::integer(left.asInt() % right.asInt());
+            break;
+
+        case BinaryOp::Mod:
+            // String format with % (printf-style)
+            // Single value: "%.2f" % 3.14
+            // Multiple values: "%d/%d" % [10 20]
+            if (left.isString()) {
+                const auto& fmt = left.asString();
+                if (right.isArray()) {
+                    return Value::string(formatMulti(fmt, right.asArray(), &interner_));
+                }
+                // Single value — use formatMulti with a one-element list
+                return Value::string(formatMulti(fmt, {right}, &interner_));
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    // Mixed int/float arithmetic and comparison
+    if (left.isNumeric() && right.isNumeric()) {
+        double a = left.asNumber();
+        double b = right.asNumber();
+        switch (op) {
+            case BinaryOp::Add: return Value::number(a + b);
+            case BinaryOp::Sub: return Value::number(a - b);
+            case BinaryOp::Mul: return Value::number(a * b);
+            case BinaryOp::Div:
+                if (b == 0.0) throw ScriptError("Division by zero", loc);
+                return Value::number(a / b);
+            case BinaryOp::Mod:
+                if (b == 0.0) throw ScriptError("Modulo by zero", loc);
+                return Value::number(std::fmod(a, b));
+            case BinaryOp::Lt: return Value::boolean(a < b);
+            case BinaryOp::Gt: return Value::boolean(a > b);
+            case BinaryOp::Le: return Value::boolean(a <= b);
+            case BinaryOp::Ge: return Value::boolean(a >= b);
+            default: break;
         }
-        if (op == "<") return Value::boolean(left.asNumber() < right.asNumber());
-        if (op == ">") return Value::boolean(left.asNumber() > right.asNumber());
-        if (op == "<=") return Value::boolean(left.asNumber() <= right.asNumber());
-        if (op == ">=") return Value::boolean(left.asNumber() >= right.asNumber());
     }
 
     // String comparison
     if (left.isString() && right.isString()) {
-        if (op == "<") return Value::boolean(left.asString() < right.asString());
-        if (op == ">") return Value::boolean(left.asString() > right.asString());
-        if (op == "<=") return Value::boolean(left.asString() <= right.asString());
-        if (op == ">=") return Value::boolean(left.asString() >= right.asString());
+        switch (op) {
+            case BinaryOp::Lt: return Value::boolean(left.asString() < right.asString());
+            case BinaryOp::Gt: return Value::boolean(left.asString() > right.asString());
+            case BinaryOp::Le: return Value::boolean(left.asString() <= right.asString());
+            case BinaryOp::Ge: return Value::boolean(left.asString() >= right.asString());
+            default: break;
+        }
     }
 
-    throw ScriptError("Cannot apply '" + op + "' to " + left.typeName() +
-        " and " + right.typeName(), loc);
+    throw ScriptError(std::string("Cannot apply '") + binaryOpName(op) + "' to " +
+        left.typeName() + " and " + right.typeName(), loc);
 }
 
 } // namespace finescript
@@ -1,24 +1,163 @@
 #include "finescript/interner.h"
+#include <cstring>
 #include <stdexcept>
 
 namespace finescript {
 
+namespace {
+
+constexpr size_t kInitialTableSize = 64;
+
+/// Split an ID into its segment and the offset inside it.
+size_t segmentOf(uint32_t id, size_t firstSegment, size_t& offset) {
+    size_t segment = 0;
+    size_t base = 0;
+    size_t size = firstSegment;
+    while (id - base >= size) {
+        base += size;
+        size <<= 1;
+        segment++;
+    }
+    offset = id - base;
+    return segment;
+}
+
+/// symbolHash(), mixed so that the high half (tags and probe starts) and
+/// the low bits (shard choice) are both well spread.
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+} // anonymous namespace
+
+DefaultInterner::Table::Table(size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<uint64_t>[capacity]) {
+    for (size_t i = 0; i < capacity; i++) slots[i].store(0, std::memory_order_relaxed);
+}
+
+DefaultInterner::Shard::Shard() {
+    tables.push_back(std::make_unique<Table>(kInitialTableSize));
+    table.store(tables.back().get(), std::memory_order_relaxed);
+}
+
+DefaultInterner::DefaultInterner() = default;
+
+DefaultInterner::DefaultInterner(std::initializer_list<StaticSymbols> tables) {
+    for (const StaticSymbols& table : tables) {
+        for (size_t i = 0; i < table.count; i++) {
+            uint32_t expected = size();
+            if (intern(table.names[i]) != expected) {
+                throw std::invalid_argument("DefaultInterner: static symbol '" +
+                                            std::string(table.names[i]) + "' listed twice");
+            }
+        }
+    }
+}
+
+DefaultInterner::~DefaultInterner() = default;
+
 uint32_t DefaultInterner::intern(std::string_view str) {
-    auto it = index_.find(str);
-    if (it != index_.end()) return it->second;
+    return intern(str, symbolHash(str));
+}
+
+uint32_t DefaultInterner::intern(std::string_view str, uint64_t hash) {
+    hash = mix(hash);
+    Shard& shard = shards_[hash % kShards];
 
-    uint32_t id = static_cast<uint32_t>(strings_.size());
-    strings_.emplace_back(str);
-    // string_view points into the deque element — stable across growth
-    index_[std::string_view(strings_.back())] = id;
+    // Hit: lock-free
+    if (uint32_t found = find(*shard.table.load(std::memory_order_acquire), hash, str)) {
+        return found - 1;
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Table* table = shard.table.load(std::memory_order_relaxed);
+    if (uint32_t found = find(*table, hash, str)) return found - 1;
+
+    uint32_t id = append(str);
+    if ((shard.count + 1) * 2 > table->mask + 1) {
+        // Keep the load factor under 1/2: copy into a table twice the size
+        auto bigger = std::make_unique<Table>((table->mask + 1) * 2);
+        for (size_t i = 0; i <= table->mask; i++) {
+            uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+            if (!slot) continue;
+            size_t j = (slot >> 32) & bigger->mask;
+            while (bigger->slots[j].load(std::memory_order_relaxed)) j = (j + 1) & bigger->mask;
+            bigger->slots[j].store(slot, std::memory_order_relaxed);
+        }
+        table = bigger.get();
+        shard.tables.push_back(std::move(bigger));
+        shard.table.store(table, std::memory_order_release);
+    }
+    uint64_t slot = (hash & 0xffffffff00000000ull) | (static_cast<uint64_t>(id) + 1);
+    size_t i = (slot >> 32) & table->mask;
+    while (table->slots[i].load(std::memory_order_relaxed)) i = (i + 1) & table->mask;
+    table->slots[i].store(slot, std::memory_order_release);
+    shard.count++;
+    return id;
+}
+
+uint32_t DefaultInterner::find(const Table& table, uint64_t hash, std::string_view str) const {
+    uint64_t tag = hash & 0xffffffff00000000ull;
+    for (size_t i = (hash >> 32) & table.mask;; i = (i + 1) & table.mask) {
+        uint64_t slot = table.slots[i].load(std::memory_order_acquire);
+        if (!slot) return 0;
+        auto found = static_cast<uint32_t>(slot);
+        if ((slot & 0xffffffff00000000ull) == tag && entry(found - 1) == str) return found;
+    }
+}
+
+uint32_t DefaultInterner::append(std::string_view str) {
+    std::lock_guard<std::mutex> lock(appendMutex_);
+    uint32_t id = count_.load(std::memory_order_relaxed);
+    if (id == UINT32_MAX) throw std::length_error("DefaultInterner: too many strings");
+    std::string_view text = store(str);
+
+    size_t offset;
+    size_t segment = segmentOf(id, kFirstSegment, offset);
+    std::string_view* entries = segments_[segment].load(std::memory_order_relaxed);
+    if (!entries) {
+        segmentOwners_[segment].reset(new std::string_view[kFirstSegment << segment]);
+        entries = segmentOwners_[segment].get();
+        segments_[segment].store(entries, std::memory_order_release);
+    }
+    entries[offset] = text;
+    count_.store(id + 1, std::memory_order_release);
     return id;
 }
 
+std::string_view DefaultInterner::store(std::string_view str) {
+    if (str.empty()) return std::string_view();
+    if (str.size() > kChunkSize / 4) {
+        chunks_.emplace_back(new char[str.size()]);
+        std::memcpy(chunks_.back().get(), str.data(), str.size());
+        return std::string_view(chunks_.back().get(), str.size());
+    }
+    if (str.size() > chunkLeft_) {
+        chunks_.emplace_back(new char[kChunkSize]);
+        chunkPos_ = chunks_.back().get();
+        chunkLeft_ = kChunkSize;
+    }
+    char* text = chunkPos_;
+    std::memcpy(text, str.data(), str.size());
+    chunkPos_ += str.size();
+    chunkLeft_ -= str.size();
+    return std::string_view(text, str.size());
+}
+
+std::string_view DefaultInterner::entry(uint32_t id) const {
+    size_t offset;
+    size_t segment = segmentOf(id, kFirstSegment, offset);
+    return segments_[segment].load(std::memory_order_acquire)[offset];
+}
+
 std::string_view DefaultInterner::lookup(uint32_t id) const {
-    if (id >= strings_.size()) {
+    if (id >= count_.load(std::memory_order_acquire)) {
         throw std::out_of_range("DefaultInterner::lookup: invalid id " + std::to_string(id));
     }
-    return strings_[id];
+    return entry(id);
 }
 
 } // namespace finescript
@@ -1,4 +1,5 @@
 #include "finescript/lexer.h"
+#include "finescript/interner.h"
 #include <stdexcept>
 #include <cctype>
 
@@ -226,14 +227,18 @@ Token Lexer::scanNumber(size_t start) {
 Token Lexer::scanName(size_t start) {
     auto startLoc = loc();
 
+    uint64_t hash = kSymbolHashSeed;
     while (!isAtEnd() && isIdentChar(current())) {
+        hash = symbolHashStep(hash, current());
         advance();
     }
 
     std::string text = source_.substr(start, pos_ - start);
     TokenType type = classifyKeyword(text);
 
-    return makeToken(type, std::move(text), startLoc);
+    Token t = makeToken(type, std::move(text), startLoc);
+    t.hash = hash;
+    return t;
 }
 
 Token Lexer::scanSymbolLiteral() {
@@ -241,11 +246,15 @@ Token Lexer::scanSymbolLiteral() {
     advance(); // consume ':'
 
     size_t nameStart = pos_;
+    uint64_t hash = kSymbolHashSeed;
     while (!isAtEnd() && isIdentChar(current())) {
+        hash = symbolHashStep(hash, current());
         advance();
     }
     std::string name = source_.substr(nameStart, pos_ - nameStart);
-    return makeToken(TokenType::SymbolLiteral, std::move(name), startLoc);
+    Token t = makeToken(TokenType::SymbolLiteral, std::move(name), startLoc);
+    t.hash = hash;
+    return t;
 }
 
 // Process escape sequences in a string segment
@@ -485,11 +494,15 @@ Token Lexer::scanToken() {
             if (isIdentStart(current())) {
                 // Key name: =identifier
                 size_t nameStart = pos_;
+                uint64_t hash = kSymbolHashSeed;
                 while (!isAtEnd() && isIdentChar(current())) {
+                    hash = symbolHashStep(hash, current());
                     advance();
                 }
                 std::string name(source_.substr(nameStart, pos_ - nameStart));
-                return makeToken(TokenType::KeyName, std::move(name), startLoc);
+                Token t = makeToken(TokenType::KeyName, std::move(name), startLoc);
+                t.hash = hash;
+                return t;
             }
             throw std::runtime_error("Unexpected '=' — did you mean '=='?");
 
@@ -1,13 +1,155 @@
 #include "finescript/map_data.h"
 #include "finescript/value.h"
+#include <algorithm>
+#include <mutex>
 
 namespace finescript {
 
+namespace {
+
+/// Edges for method marks, as opposed to added keys.
+constexpr uint64_t kMethodEdge = uint64_t(1) << 32;
+
+/// Upper bound on shapes ever created; beyond it new layouts become
+/// dictionaries, so maps keyed by arbitrary data cannot grow the tree forever.
+constexpr size_t kMaxShapes = 1 << 16;
+
+std::mutex shapeMutex;
+size_t shapeCount = 0;
+
+} // anonymous namespace
+
+// -- ProxyMap --
+
+namespace {
+
+class KeySnapshotIterator : public ProxyMap::Iterator {
+public:
+    explicit KeySnapshotIterator(const ProxyMap& proxy) : proxy_(proxy), keys_(proxy.keys()) {}
+
+    bool next(uint32_t& key, Value& value) override {
+        if (pos_ >= keys_.size()) return false;
+        key = keys_[pos_++];
+        value = proxy_.get(key);
+        return true;
+    }
+
+private:
+    const ProxyMap& proxy_;
+    std::vector<uint32_t> keys_;
+    size_t pos_ = 0;
+};
+
+} // anonymous namespace
+
+std::unique_ptr<ProxyMap::Iterator> ProxyMap::iterate() const {
+    return std::make_unique<KeySnapshotIterator>(*this);
+}
+
+// -- Shape --
+
+const Shape* Shape::empty() {
+    static const Shape* root = new Shape();
+    return root;
+}
+
+const Shape* Shape::withKey(uint32_t key) const {
+    if (keys_.size() >= kMaxKeys) return nullptr;
+    return transition(key, methods_);
+}
+
+const Shape* Shape::withMethod(size_t index) const {
+    return transition(keys_[index] | kMethodEdge, methods_ | (1u << index));
+}
+
+/// Open-addressed table of a shape's children. Readers probe it without a
+/// lock: a slot's edge is written before its child pointer is released, and
+/// a null child ends the probe. Inserts happen under shapeMutex and keep the
+/// table at most half full; a full table is replaced by a larger copy, and
+/// the old one stays alive (owned by its successor) for readers still in it.
+struct Shape::TransitionTable {
+    struct Slot {
+        uint64_t edge = 0;
+        std::atomic<const Shape*> child{nullptr};
+    };
+
+    explicit TransitionTable(size_t capacity)
+        : mask(capacity - 1), slots(new Slot[capacity]) {}
+
+    static size_t hash(uint64_t edge) {
+        return static_cast<size_t>((edge * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    const Shape* find(uint64_t edge) const {
+        for (size_t i = hash(edge) & mask;; i = (i + 1) & mask) {
+            const Shape* child = slots[i].child.load(std::memory_order_acquire);
+            if (!child || slots[i].edge == edge) return child;
+        }
+    }
+
+    bool full() const { return (used + 1) * 2 > mask + 1; }
+
+    void insert(uint64_t edge, const Shape* child) {
+        size_t i = hash(edge) & mask;
+        while (slots[i].child.load(std::memory_order_relaxed)) i = (i + 1) & mask;
+        slots[i].edge = edge;
+        slots[i].child.store(child, std::memory_order_release);
+        used++;
+    }
+
+    size_t mask;
+    size_t used = 0;
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<TransitionTable> previous;
+};
+
+const Shape* Shape::transition(uint64_t edge, uint32_t methods) const {
+    // Existing transitions, the common case, need no lock
+    if (const TransitionTable* table = transitions_.load(std::memory_order_acquire)) {
+        if (const Shape* child = table->find(edge)) return child;
+    }
+
+    std::lock_guard<std::mutex> lock(shapeMutex);
+    TransitionTable* table = transitions_.load(std::memory_order_relaxed);
+    if (table) {
+        // Another thread may have added it since the unlocked lookup
+        if (const Shape* child = table->find(edge)) return child;
+    }
+    if (shapeCount >= kMaxShapes) return nullptr;
+    shapeCount++;
+    auto* child = new Shape();
+    child->keys_ = keys_;
+    if (!(edge & kMethodEdge)) child->keys_.push_back(static_cast<uint32_t>(edge));
+    child->methods_ = methods;
+
+    if (!table || table->full()) {
+        auto grown = std::make_unique<TransitionTable>(table ? 2 * (table->mask + 1) : 4);
+        if (table) {
+            for (size_t i = 0; i <= table->mask; i++) {
+                if (const Shape* c = table->slots[i].child.load(std::memory_order_relaxed)) {
+                    grown->insert(table->slots[i].edge, c);
+                }
+            }
+            grown->previous.reset(table);
+        }
+        grown->insert(edge, child);
+        transitions_.store(grown.release(), std::memory_order_release);
+    } else {
+        table->insert(edge, child);
+    }
+    return child;
+}
+
+// -- MapData --
+
 Value MapData::get(uint32_t key) const {
     if (proxy_) return proxy_->get(key);
-    auto it = entries_.find(key);
-    if (it != entries_.end()) return it->second;
-    return Value::nil();
+    if (shape_) {
+        int idx = shape_->indexOf(key);
+        return idx >= 0 ? values_[idx] : Value::nil();
+    }
+    Value* v = dict_->find(key);
+    return v ? *v : Value::nil();
 }
 
 void MapData::set(uint32_t key, Value value) {
@@ -15,45 +157,189 @@ void MapData::set(uint32_t key, Value value) {
         proxy_->set(key, std::move(value));
         return;
     }
-    entries_[key] = std::move(value);
+    if (shape_) {
+        int idx = shape_->indexOf(key);
+        if (idx >= 0) {
+            values_[idx] = std::move(value);
+            return;
+        }
+        if (const Shape* next = shape_->withKey(key)) {
+            shape_ = next;
+            values_.push_back(std::move(value));
+            return;
+        }
+        toDictionary();
+    }
+    dict_->set(key, std::move(value));
 }
 
 bool MapData::has(uint32_t key) const {
     if (proxy_) return proxy_->has(key);
-    return entries_.count(key) > 0;
+    if (shape_) return shape_->indexOf(key) >= 0;
+    return dict_->index.count(key) > 0;
 }
 
 bool MapData::remove(uint32_t key) {
-    methodKeys_.erase(key);
-    if (proxy_) return proxy_->remove(key);
-    return entries_.erase(key) > 0;
+    if (proxy_) {
+        dict_->methodKeys.erase(key);
+        return proxy_->remove(key);
+    }
+    if (shape_) {
+        if (shape_->indexOf(key) < 0) return false;
+        toDictionary();
+    }
+    dict_->methodKeys.erase(key);
+    return dict_->remove(key);
 }
 
 std::vector<uint32_t> MapData::keys() const {
     if (proxy_) return proxy_->keys();
+    if (shape_) return shape_->keys();
     std::vector<uint32_t> result;
-    result.reserve(entries_.size());
-    for (auto& [k, v] : entries_) {
-        result.push_back(k);
+    result.reserve(dict_->index.size());
+    for (const auto& entry : dict_->entries) {
+        if (entry.live) result.push_back(entry.key);
     }
     return result;
 }
 
-void MapData::setMethod(uint32_t key, Value funcValue) {
-    if (proxy_) {
-        proxy_->set(key, std::move(funcValue));
-    } else {
-        entries_[key] = std::move(funcValue);
+std::vector<Value> MapData::values() const {
+    std::vector<Value> result;
+    result.reserve(size());
+    forEach([&](uint32_t, const Value& value) { result.push_back(value); });
+    return result;
+}
+
+bool MapData::nextEntry(size_t& cursor, uint32_t& key, Value& value) const {
+    if (shape_) {
+        if (cursor >= values_.size()) return false;
+        key = shape_->keys()[cursor];
+        value = values_[cursor++];
+        return true;
     }
-    methodKeys_.insert(key);
+    const auto& entries = dict_->entries;
+    size_t pos = cursor;
+    if (dict_->nextSeq != entries.size()) {
+        // Compacted since insertion numbers were positions: search for it
+        pos = std::lower_bound(entries.begin(), entries.end(), cursor,
+                               [](const Dict::Entry& e, size_t seq) { return e.seq < seq; }) -
+              entries.begin();
+    }
+    while (pos < entries.size() && !entries[pos].live) pos++;
+    if (pos >= entries.size()) return false;
+    key = entries[pos].key;
+    value = entries[pos].value;
+    cursor = entries[pos].seq + 1;
+    return true;
+}
+
+size_t MapData::size() const {
+    if (proxy_) return proxy_->keys().size();
+    if (shape_) return shape_->size();
+    return dict_->index.size();
+}
+
+void MapData::setMethod(uint32_t key, Value funcValue) {
+    set(key, std::move(funcValue));
+    markMethod(key);
 }
 
 void MapData::markMethod(uint32_t key) {
-    methodKeys_.insert(key);
+    if (shape_) {
+        int idx = shape_->indexOf(key);
+        if (idx >= 0) {
+            if (!shape_->isMethod(idx)) {
+                if (const Shape* next = shape_->withMethod(idx)) {
+                    shape_ = next;
+                    return;
+                }
+                toDictionary();
+            } else {
+                return;
+            }
+        } else {
+            // Marking a key before it exists: only a dictionary can say that
+            toDictionary();
+        }
+    }
+    dict_->methodKeys.insert(key);
 }
 
 bool MapData::isMethod(uint32_t key) const {
-    return methodKeys_.count(key) > 0;
+    if (shape_) {
+        int idx = shape_->indexOf(key);
+        return idx >= 0 && shape_->isMethod(idx);
+    }
+    return dict_->methodKeys.count(key) > 0;
+}
+
+bool MapData::lookupSlow(uint32_t key, FieldCache& cache, Value& out,
+                         bool& method) const {
+    if (!shape_) {
+        method = isMethod(key);
+        if (!has(key)) return false;
+        out = get(key);
+        return true;
+    }
+    int idx = shape_->indexOf(key);
+    cache.shape = shape_;
+    cache.index = idx >= 0 ? static_cast<uint32_t>(idx) : FieldCache::kAbsent;
+    cache.method = idx >= 0 && shape_->isMethod(idx);
+    method = cache.method;
+    if (idx < 0) return false;
+    out = values_[idx];
+    return true;
+}
+
+void MapData::toDictionary() {
+    auto dict = std::make_unique<Dict>();
+    const auto& keys = shape_->keys();
+    dict->entries.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        dict->set(keys[i], std::move(values_[i]));
+        if (shape_->isMethod(i)) dict->methodKeys.insert(keys[i]);
+    }
+    shape_ = nullptr;
+    values_ = std::vector<Value>();
+    dict_ = std::move(dict);
+}
+
+// -- MapData::Dict --
+
+Value* MapData::Dict::find(uint32_t key) {
+    auto it = index.find(key);
+    return it != index.end() ? &entries[it->second].value : nullptr;
+}
+
+void MapData::Dict::set(uint32_t key, Value value) {
+    auto [it, inserted] = index.try_emplace(key, static_cast<uint32_t>(entries.size()));
+    if (!inserted) {
+        entries[it->second].value = std::move(value);
+        return;
+    }
+    entries.push_back({key, true, nextSeq++, std::move(value)});
+}
+
+bool MapData::Dict::remove(uint32_t key) {
+    auto it = index.find(key);
+    if (it == index.end()) return false;
+    Entry& entry = entries[it->second];
+    entry.live = false;
+    entry.value = Value();
+    index.erase(it);
+    if (++dead > index.size()) {
+        // Compact, keeping the survivors in order
+        size_t out = 0;
+        for (auto& e : entries) {
+            if (!e.live) continue;
+            index[e.key] = static_cast<uint32_t>(out);
+            if (&entries[out] != &e) entries[out] = std::move(e);
+            out++;
+        }
+        entries.resize(out);
+        dead = 0;
+    }
+    return true;
 }
 
 } // namespace finescript
@@ -101,11 +101,57 @@ std::unique_ptr<AstNode> makeInfix(std::string op, std::unique_ptr<AstNode> left
     n->kind = AstNodeKind::Infix;
     n->loc = loc;
     n->op = std::move(op);
+    n->binOp = binaryOpFromString(n->op);
     n->children.push_back(std::move(left));
     n->children.push_back(std::move(right));
     return n;
 }
 
+BinaryOp binaryOpFromString(std::string_view op) {
+    if (op == "+") return BinaryOp::Add;
+    if (op == "-") return BinaryOp::Sub;
+    if (op == "*") return BinaryOp::Mul;
+    if (op == "/") return BinaryOp::Div;
+    if (op == "%") return BinaryOp::Mod;
+    if (op == "==") return BinaryOp::Eq;
+    if (op == "!=") return BinaryOp::Ne;
+    if (op == "<") return BinaryOp::Lt;
+    if (op == ">") return BinaryOp::Gt;
+    if (op == "<=") return BinaryOp::Le;
+    if (op == ">=") return BinaryOp::Ge;
+    if (op == "..") return BinaryOp::Range;
+    if (op == "..=") return BinaryOp::RangeIncl;
+    if (op == "and") return BinaryOp::And;
+    if (op == "or") return BinaryOp::Or;
+    if (op == "??") return BinaryOp::NilCoalesce;
+    if (op == "?:") return BinaryOp::FalsyCoalesce;
+    return BinaryOp::None;
+}
+
+const char* binaryOpName(BinaryOp op) {
+    switch (op) {
+        case BinaryOp::Add:           return "+";
+        case BinaryOp::Sub:           return "-";
+        case BinaryOp::Mul:           return "*";
+        case BinaryOp::Div:           return "/";
+        case BinaryOp::Mod:           return "%";
+        case BinaryOp::Eq:            return "==";
+        case BinaryOp::Ne:            return "!=";
+        case BinaryOp::Lt:            return "<";
+        case BinaryOp::Gt:            return ">";
+        case BinaryOp::Le:            return "<=";
+        case BinaryOp::Ge:            return ">=";
+        case BinaryOp::Range:         return "..";
+        case BinaryOp::RangeIncl:     return "..=";
+        case BinaryOp::And:           return "and";
+        case BinaryOp::Or:            return "or";
+        case BinaryOp::NilCoalesce:   return "??";
+        case BinaryOp::FalsyCoalesce: return "?:";
+        case BinaryOp::None:          break;
+    }
+    return "?";
+}
+
 std::unique_ptr<AstNode> makeUnaryNot(std::unique_ptr<AstNode> operand, SourceLocation loc) {
     auto n = std::make_unique<AstNode>();
     n->kind = AstNodeKind::UnaryNot;
@@ -371,6 +417,7 @@ private:
             case TokenType::SymbolLiteral:
                 lexer_.next();
                 node = makeSymbolLit(tok.text, tok.location);
+                node->nameHash = tok.hash;
                 break;
             case TokenType::BoolTrue:
                 lexer_.next();
@@ -387,6 +434,7 @@ private:
             case TokenType::Name:
                 lexer_.next();
                 node = makeName(tok.text, tok.location);
+                node->nameHash = tok.hash;
                 break;
             case TokenType::Underscore:
                 lexer_.next();
@@ -766,13 +814,18 @@ private:
     std::unique_ptr<AstNode> parseFor() {
         auto loc = lexer_.next().location; // consume 'for'
         auto varTok = expect(TokenType::Name, "Expected loop variable");
+        // `for key value in ...`: key (or index) and value
+        std::string valueName;
+        if (lexer_.peek().type == TokenType::Name) valueName = lexer_.next().text;
         expect(TokenType::In, "Expected 'in'");
         auto iterable = parseRangeOrAtom();
         expect(TokenType::Do, "Expected 'do'");
         auto stmts = parseStatementsUntil({TokenType::End});
         expect(TokenType::End, "Expected 'end'");
-        return makeFor(varTok.text, std::move(iterable),
-                       makeBlock(std::move(stmts), loc), loc);
+        auto node = makeFor(varTok.text, std::move(iterable),
+                            makeBlock(std::move(stmts), loc), loc);
+        if (!valueName.empty()) node->nameParts.push_back(std::move(valueName));
+        return node;
     }
 
     std::unique_ptr<AstNode> parseWhile() {
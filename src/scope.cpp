@@ -1,52 +1,332 @@
 #include "finescript/scope.h"
+#include <atomic>
+#include <mutex>
+#include <new>
 
 namespace finescript {
 
-Scope::Scope(std::shared_ptr<Scope> parent) : parent_(std::move(parent)) {}
+/// Free lists of recycled blocks in a few power-of-two size classes. Lives
+/// as long as any block allocated from it (each block holds a reference), so
+/// scopes that outlive their engine still free into a valid pool. With
+/// FINESCRIPT_ATOMIC_REFCOUNT a closure Value may be dropped on another
+/// thread, freeing its frames while the script thread allocates, so the
+/// count is atomic and the free lists are locked.
+class FramePool {
+public:
+    static FramePool* create() { return new FramePool(); }
+
+    void* allocate(size_t bytes) {
+        retain();
+        size_t cls = sizeClass(bytes);
+        if (cls >= kClasses) return ::operator new(bytes);
+        {
+            Lock lock(mutex_);
+            auto& list = free_[cls];
+            if (!list.empty()) {
+                void* p = list.back();
+                list.pop_back();
+                return p;
+            }
+        }
+        return ::operator new(kMinBlock << cls);
+    }
+
+    void deallocate(void* p, size_t bytes) {
+        size_t cls = sizeClass(bytes);
+        bool kept = false;
+        if (cls < kClasses) {
+            Lock lock(mutex_);
+            if (free_[cls].size() < kMaxFree) {
+                free_[cls].push_back(p);
+                kept = true;
+            }
+        }
+        if (!kept) ::operator delete(p);
+        release();
+    }
+
+    void release() {
+#if FINESCRIPT_ATOMIC_REFCOUNT
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+#else
+        if (--refs_ == 0) delete this;
+#endif
+    }
+
+private:
+    static constexpr size_t kMinBlock = 64;
+    static constexpr size_t kClasses = 5;     // 64 .. 1024 bytes
+    static constexpr size_t kMaxFree = 256;   // per class
+
+#if FINESCRIPT_ATOMIC_REFCOUNT
+    using Mutex = std::mutex;
+    using Lock = std::lock_guard<std::mutex>;
+    std::atomic<size_t> refs_{1};   // the creator's reference, dropped by release()
+    void retain() { refs_.fetch_add(1, std::memory_order_relaxed); }
+#else
+    struct Mutex {};
+    struct Lock {
+        explicit Lock(Mutex&) {}
+    };
+    size_t refs_ = 1;   // the creator's reference, dropped by release()
+    void retain() { ++refs_; }
+#endif
+
+    Mutex mutex_;
+    std::vector<void*> free_[kClasses];
+
+    FramePool() = default;
+    ~FramePool() {
+        for (auto& list : free_) {
+            for (void* p : list) ::operator delete(p);
+        }
+    }
+
+    static size_t sizeClass(size_t bytes) {
+        size_t cls = 0;
+        while ((kMinBlock << cls) < bytes) cls++;
+        return cls;
+    }
+};
+
+namespace {
+
+template <class T>
+struct FrameAllocator {
+    using value_type = T;
+    FramePool* pool;
+
+    explicit FrameAllocator(FramePool* p) : pool(p) {}
+    template <class U>
+    FrameAllocator(const FrameAllocator<U>& other) : pool(other.pool) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(pool->allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { pool->deallocate(p, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const FrameAllocator<U>& other) const { return pool == other.pool; }
+    template <class U>
+    bool operator!=(const FrameAllocator<U>& other) const { return pool != other.pool; }
+};
+
+} // anonymous namespace
+
+Scope::Scope(Key, FramePool* pool, std::shared_ptr<Scope> parent,
+             std::shared_ptr<const ScopeLayout> layout)
+    : pool_(pool), parent_(std::move(parent)), layout_(std::move(layout)) {
+    if (layout_ && !layout_->names.empty()) {
+        size_t n = layout_->names.size();
+        slots_ = static_cast<Slot*>(pool_->allocate(n * sizeof(Slot)));
+        for (size_t i = 0; i < n; i++) new (&slots_[i]) Slot();
+    }
+}
+
+Scope::~Scope() {
+    if (slots_) {
+        size_t n = layout_->names.size();
+        for (size_t i = 0; i < n; i++) slots_[i].~Slot();
+        pool_->deallocate(slots_, n * sizeof(Slot));
+    }
+}
 
 std::shared_ptr<Scope> Scope::createGlobal() {
-    return std::shared_ptr<Scope>(new Scope(nullptr));
+    FramePool* pool = FramePool::create();
+    auto global = std::allocate_shared<Scope>(FrameAllocator<Scope>(pool), Key(), pool,
+                                              nullptr, nullptr);
+    pool->release();   // from here on the pool is owned by its blocks
+    return global;
 }
 
 std::shared_ptr<Scope> Scope::createChild() {
-    return std::shared_ptr<Scope>(new Scope(shared_from_this()));
+    return std::allocate_shared<Scope>(FrameAllocator<Scope>(pool_), Key(), pool_,
+                                       shared_from_this(), nullptr);
+}
+
+std::shared_ptr<Scope> Scope::createChild(std::shared_ptr<const ScopeLayout> layout) {
+    return std::allocate_shared<Scope>(FrameAllocator<Scope>(pool_), Key(), pool_,
+                                       shared_from_this(), std::move(layout));
+}
+
+std::shared_ptr<Scope> Scope::createFrame(std::shared_ptr<const ScopeLayout> layout) {
+    auto frame = createChild(std::move(layout));
+    frame->frame_ = true;
+    return frame;
+}
+
+Scope::SharedCell* Scope::Slot::share() {
+    if (!shared) {
+        shared = new SharedCell();
+        shared->value = std::move(local.value);
+        shared->bound = local.bound;
+        local = Cell();
+    }
+    return shared;
+}
+
+std::shared_ptr<Scope> Scope::capture(const std::vector<uint32_t>& names) {
+    if (!frame_) return shared_from_this();
+
+    // Frames from here up to the first persistent scope, innermost first
+    std::vector<Scope*> frames;
+    Scope* outer = this;
+    while (outer && outer->frame_) {
+        frames.push_back(outer);
+        outer = outer->parent_.get();
+    }
+
+    struct Captured {
+        size_t frame;
+        uint32_t symbol;
+        Slot* entry;
+    };
+    std::vector<Captured> captured;
+    captured.reserve(names.size());
+    size_t top = 0;
+    auto add = [&](size_t frame, uint32_t name, Slot* entry) {
+        captured.push_back({frame, name, entry});
+        if (frame > top) top = frame;
+    };
+    for (uint32_t name : names) {
+        // Share the innermost binding, if the name is bound in a frame
+        Slot* entry = nullptr;
+        Slot* unbound = nullptr;   // innermost slot or placeholder
+        size_t i = 0;
+        size_t unboundFrame = 0;
+        for (; i < frames.size(); i++) {
+            Slot* found = frames[i]->findEntry(name);
+            if (found && found->get()) {
+                entry = found;
+                break;
+            }
+            if (found && !unbound) {
+                unbound = found;
+                unboundFrame = i;
+            }
+        }
+        if (entry) {
+            add(i, name, entry);
+            continue;
+        }
+        if (outer && outer->lookup(name)) {
+            // Bound past the frames (usually a global): only a local define
+            // can still shadow it, in a slot or in a placeholder here
+            if (unbound) add(unboundFrame, name, unbound);
+            else if (!layout_) add(0, name, &addBinding(name));
+            continue;
+        }
+        // Not bound yet. A later set, fn or define binds it in whichever
+        // frame runs it (a set in a loop body binds in the loop frame, a
+        // helper defined after the loop in the function frame), so share
+        // an entry of every frame; lookups skip the unbound ones.
+        for (size_t j = 0; j < frames.size(); j++) {
+            Slot* placeholder = frames[j]->findEntry(name);
+            add(j, name, placeholder ? placeholder : &frames[j]->addBinding(name));
+        }
+    }
+    if (captured.empty()) return outer ? outer->shared_from_this() : shared_from_this();
+
+    // Copy frames 0..top (outermost first) onto the persistent scope
+    std::vector<Scope*> copies(top + 1);
+    std::shared_ptr<Scope> chain = outer ? outer->shared_from_this() : nullptr;
+    for (size_t i = top + 1; i-- > 0;) {
+        Scope* frame = frames[i];
+        chain = std::allocate_shared<Scope>(FrameAllocator<Scope>(frame->pool_), Key(),
+                                            frame->pool_, std::move(chain), frame->layout_);
+        chain->frame_ = true;
+        copies[i] = chain.get();
+    }
+
+    for (auto& c : captured) {
+        Scope* copy = copies[c.frame];
+        int idx = copy->slotIndex(c.symbol);
+        Slot& dst = idx >= 0 ? copy->slots_[idx] : copy->addBinding(c.symbol);
+        dst.shared = c.entry->share();
+        dst.shared->refs++;
+    }
+    return chain;
+}
+
+int Scope::slotIndex(uint32_t symbolId) const {
+    if (!layout_) return -1;
+    const auto& names = layout_->names;
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == symbolId) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+Scope::Slot* Scope::findEntry(uint32_t symbolId) {
+    // A layout name lives only in its slot, never in the bindings
+    int idx = slotIndex(symbolId);
+    if (idx >= 0) return &slots_[idx];
+    for (size_t i = 0; i < numInline_; i++) {
+        if (inline_[i].symbol == symbolId) return &inline_[i].entry;
+    }
+    if (overflow_) {
+        auto it = overflow_->find(symbolId);
+        if (it != overflow_->end()) return &it->second;
+    }
+    return nullptr;
+}
+
+Scope::Slot& Scope::addBinding(uint32_t symbolId) {
+    if (numInline_ < kInlineBindings) {
+        inline_[numInline_].symbol = symbolId;
+        return inline_[numInline_++].entry;
+    }
+    if (!overflow_) overflow_ = std::make_unique<std::unordered_map<uint32_t, Slot>>();
+    return (*overflow_)[symbolId];
+}
+
+Value* Scope::findLocal(uint32_t symbolId) {
+    Slot* entry = findEntry(symbolId);
+    return entry ? entry->get() : nullptr;
 }
 
 Value* Scope::lookup(uint32_t symbolId) {
-    auto it = bindings_.find(symbolId);
-    if (it != bindings_.end()) return &it->second;
-    if (parent_) return parent_->lookup(symbolId);
+    for (Scope* s = this; s; s = s->parent_.get()) {
+        if (Value* v = s->findLocal(symbolId)) return v;
+    }
     return nullptr;
 }
 
 void Scope::set(uint32_t symbolId, Value value) {
     // Python semantics: find in chain, update there; else create here
-    Scope* s = this;
-    while (s) {
-        auto it = s->bindings_.find(symbolId);
-        if (it != s->bindings_.end()) {
-            it->second = std::move(value);
+    for (Scope* s = this; s; s = s->parent_.get()) {
+        if (Value* v = s->findLocal(symbolId)) {
+            *v = std::move(value);
             return;
         }
-        s = s->parent_.get();
     }
     // Not found anywhere — create in this scope
-    bindings_[symbolId] = std::move(value);
+    define(symbolId, std::move(value));
 }
 
 void Scope::define(uint32_t symbolId, Value value) {
-    bindings_[symbolId] = std::move(value);
+    Slot* entry = findEntry(symbolId);
+    if (!entry) entry = &addBinding(symbolId);
+    entry->put(std::move(value));
 }
 
 bool Scope::hasLocal(uint32_t symbolId) const {
-    return bindings_.count(symbolId) > 0;
+    return const_cast<Scope*>(this)->findLocal(symbolId) != nullptr;
 }
 
 std::vector<uint32_t> Scope::localKeys() const {
     std::vector<uint32_t> result;
-    result.reserve(bindings_.size());
-    for (auto& [k, v] : bindings_) {
-        result.push_back(k);
+    result.reserve(numInline_ + (overflow_ ? overflow_->size() : 0));
+    if (layout_) {
+        for (size_t i = 0; i < layout_->names.size(); i++) {
+            if (slots_[i].cell().bound) result.push_back(layout_->names[i]);
+        }
+    }
+    for (size_t i = 0; i < numInline_; i++) {
+        if (inline_[i].entry.cell().bound) result.push_back(inline_[i].symbol);
+    }
+    if (overflow_) {
+        for (auto& [k, entry] : *overflow_) {
+            if (entry.cell().bound) result.push_back(k);
+        }
     }
     return result;
 }
@@ -1,15 +1,20 @@
 #include "finescript/script_engine.h"
 #include "finescript/interner.h"
+#include "finescript/builtin_symbols.h"
 #include "finescript/scope.h"
 #include "finescript/evaluator.h"
 #include "finescript/execution_context.h"
 #include "finescript/parser.h"
+#include "finescript/compiler.h"
 #include "finescript/native_function.h"
 #include "finescript/builtins.h"
 #include "finescript/resource_finder.h"
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace finescript {
 
@@ -25,8 +30,48 @@ struct ScriptEngine::Impl {
     };
     std::unordered_map<std::string, CachedScript> cache;
 
+    // Shared by execute() and callFunction() so the evaluator's symbol table
+    // is interned once per interner, not once per call. The evaluator is
+    // re-entrant, so a native function calling back into the engine reuses
+    // it; callers hold their own reference in case setInterner() drops it.
+    std::shared_ptr<Evaluator> evaluator;
+
+    // registerMethod() calls, replayed into each new evaluator (method
+    // tables are keyed by symbol IDs, which change with the interner)
+    struct RegisteredMethod {
+        Value::Type type;
+        std::string name;
+        Value function;
+    };
+    std::vector<RegisteredMethod> methods;
+
+    std::shared_ptr<Evaluator> acquireEvaluator(ScriptEngine& engine) {
+        if (!evaluator) {
+            evaluator = std::make_shared<Evaluator>(*interner, globalScope, &engine);
+            for (const auto& m : methods) {
+                evaluator->setMethod(m.type, interner->intern(m.name), m.function);
+            }
+        }
+        return evaluator;
+    }
+
+    // With non-atomic refcounts every value the engine holds belongs to one
+    // thread; entry points check they are called from it.
+    std::thread::id ownerThread = std::this_thread::get_id();
+
+    void checkThread() const {
+#if !FINESCRIPT_ATOMIC_REFCOUNT
+        if (std::this_thread::get_id() != ownerThread) {
+            throw std::logic_error("ScriptEngine used from a thread other than its owner "
+                                   "(call bindToCurrentThread() after handing it over)");
+        }
+#endif
+    }
+
     Impl() {
-        ownedInterner = std::make_unique<DefaultInterner>();
+        // Builtin symbols get fixed IDs, so method dispatch can index by ID
+        ownedInterner = std::make_unique<DefaultInterner>(
+            std::initializer_list<StaticSymbols>{builtinSymbols()});
         interner = ownedInterner.get();
         globalScope = Scope::createGlobal();
     }
@@ -38,6 +83,10 @@ ScriptEngine::ScriptEngine() : impl_(std::make_unique<Impl>()) {
 
 ScriptEngine::~ScriptEngine() = default;
 
+void ScriptEngine::bindToCurrentThread() {
+    impl_->ownerThread = std::this_thread::get_id();
+}
+
 CompiledScript* ScriptEngine::loadScript(const std::filesystem::path& path) {
     auto key = path.string();
     auto modTime = std::filesystem::last_write_time(path);
@@ -67,6 +116,7 @@ std::unique_ptr<CompiledScript> ScriptEngine::parseString(std::string_view sourc
     auto script = std::make_unique<CompiledScript>();
     script->name = std::string(name);
     script->root = Parser::parse(source);
+    bindSymbols(*script->root, interner());
     return script;
 }
 
@@ -79,11 +129,13 @@ void ScriptEngine::invalidateAllCaches() {
 }
 
 FullScriptResult ScriptEngine::execute(const CompiledScript& script, ExecutionContext& context) {
+    impl_->checkThread();
     FullScriptResult result;
     try {
-        Evaluator evaluator(interner(), impl_->globalScope, this);
-        // Execute in context scope so definitions persist across commands
-        result.returnValue = evaluator.eval(script.root, context.scope(), &context);
+        auto evaluator = impl_->acquireEvaluator(*this);
+        // Execute in context scope so definitions persist across commands.
+        // A top-level return ends the script with its value.
+        result.returnValue = evaluator->run(*bytecode(script), context.scope(), &context);
         result.success = true;
     } catch (const ScriptError& e) {
         result.success = false;
@@ -91,10 +143,6 @@ FullScriptResult ScriptEngine::execute(const CompiledScript& script, ExecutionCo
         result.scriptName = script.name;
         result.errorLine = e.location().line;
         result.errorColumn = e.location().column;
-    } catch (const ReturnSignal& sig) {
-        // Top-level return — use the value as script result
-        result.returnValue = sig.value();
-        result.success = true;
     } catch (const std::exception& e) {
         result.success = false;
         result.error = e.what();
@@ -117,21 +165,29 @@ FullScriptResult ScriptEngine::executeCommand(std::string_view command, Executio
     return execute(*script, context);
 }
 
-Value ScriptEngine::callFunction(const Value& callable, std::vector<Value> args,
+std::shared_ptr<const Chunk> ScriptEngine::bytecode(const CompiledScript& script) {
+    if (!script.chunk || script.chunk->interner != impl_->interner) {
+        script.chunk = Compiler::compile(script.root, interner(), script.name);
+    }
+    return script.chunk;
+}
+
+Value ScriptEngine::callFunction(const Value& callable, ArgSpan args,
                                  ExecutionContext& context) {
+    impl_->checkThread();
     if (callable.isNativeFunction()) {
         return const_cast<Value&>(callable).asNativeFunction().call(context, args);
     }
     if (callable.isClosure()) {
-        Evaluator evaluator(interner(), impl_->globalScope, this);
-        return evaluator.callFunction(callable, std::move(args),
-                                      context.scope(), &context, SourceLocation{});
+        auto evaluator = impl_->acquireEvaluator(*this);
+        return evaluator->callFunction(callable, args,
+                                       context.scope(), &context, SourceLocation{});
     }
     throw std::runtime_error("callFunction: value is not callable");
 }
 
 void ScriptEngine::registerFunction(std::string_view name,
-                                    std::function<Value(ExecutionContext&, const std::vector<Value>&)> func) {
+                                    std::function<Value(ExecutionContext&, ArgSpan)> func) {
     auto nativeObj = std::make_shared<SimpleLambdaFunction>(std::move(func));
     impl_->globalScope->define(intern(name), Value::nativeFunction(std::move(nativeObj)));
 }
@@ -140,6 +196,14 @@ void ScriptEngine::registerConstant(std::string_view name, Value value) {
     impl_->globalScope->define(intern(name), std::move(value));
 }
 
+void ScriptEngine::registerMethod(Value::Type type, std::string_view name,
+                                  std::function<Value(ExecutionContext&, ArgSpan)> func) {
+    auto nativeObj = std::make_shared<SimpleLambdaFunction>(std::move(func));
+    Value function = Value::nativeFunction(std::move(nativeObj));
+    if (impl_->evaluator) impl_->evaluator->setMethod(type, intern(name), function);
+    impl_->methods.push_back({type, std::string(name), std::move(function)});
+}
+
 void ScriptEngine::setResourceFinder(ResourceFinder* finder) {
     impl_->resourceFinder = finder;
 }
@@ -153,6 +217,7 @@ std::filesystem::path ScriptEngine::resolveScript(std::string_view name) {
 
 void ScriptEngine::setInterner(Interner* interner) {
     impl_->interner = interner;
+    impl_->evaluator.reset();  // its pre-interned symbols belong to the old interner
 }
 
 uint32_t ScriptEngine::intern(std::string_view str) {
@@ -0,0 +1,96 @@
+#include "finescript/ast.h"
+#include "finescript/interner.h"
+#include <algorithm>
+
+namespace finescript {
+
+/// `names` collects the names referenced inside the enclosing function.
+static void bindNode(AstNode& node, Interner& interner, std::vector<uint32_t>* names) {
+    switch (node.kind) {
+        case AstNodeKind::Name:
+        case AstNodeKind::SymbolLit:
+        case AstNodeKind::On:
+            // The lexer already hashed most names while scanning them
+            node.symbolId = node.nameHash ? interner.intern(node.stringValue, node.nameHash)
+                                          : interner.intern(node.stringValue);
+            break;
+        case AstNodeKind::StringLit:
+            node.literal = Value::sharedString(node.stringValue);
+            break;
+        case AstNodeKind::Fn:
+            node.symbolId = node.stringValue.empty() ? kNoSymbol
+                                                     : interner.intern(node.stringValue);
+            if (!node.op.empty()) {
+                // Variadic params: op = "restName|kwargsName" (pipe-delimited)
+                auto pipe = node.op.find('|');
+                std::string_view op(node.op);
+                std::string_view restName = op.substr(0, pipe);
+                std::string_view kwargsName =
+                    pipe == std::string::npos ? std::string_view() : op.substr(pipe + 1);
+                node.restId = restName.empty() ? kNoSymbol : interner.intern(restName);
+                node.kwargsId = kwargsName.empty() ? kNoSymbol : interner.intern(kwargsName);
+            }
+            break;
+        default:
+            break;
+    }
+
+    node.nameIds.clear();
+    node.nameIds.reserve(node.nameParts.size());
+    for (const auto& part : node.nameParts) {
+        node.nameIds.push_back(interner.intern(part));
+    }
+    if (node.kind == AstNodeKind::DottedName || node.kind == AstNodeKind::Set) {
+        node.fieldCaches.assign(node.nameIds.size(), FieldCache());
+    }
+    if (node.kind == AstNodeKind::Set && node.nameParts.size() == 1) {
+        // set s (s + x) or set s "{s}..."
+        const AstNode& value = *node.children[0];
+        auto isTarget = [&](const AstNode& n) {
+            return n.kind == AstNodeKind::Name && n.stringValue == node.nameParts[0];
+        };
+        // An interpolated {s} is a zero-arg call of s
+        auto isTargetCall = [&](const AstNode& n) {
+            return n.kind == AstNodeKind::Call && n.children.size() == 1 &&
+                   n.nameParts.empty() && isTarget(*n.children[0]);
+        };
+        node.selfAppend =
+            (value.kind == AstNodeKind::Infix && value.binOp == BinaryOp::Add &&
+             isTarget(*value.children[0])) ||
+            (value.kind == AstNodeKind::StringInterp && value.children.size() > 1 &&
+             isTargetCall(*value.children[0]));
+    }
+
+    if (node.kind == AstNodeKind::Fn) {
+        std::vector<uint32_t> inner;
+        for (auto& child : node.children) {
+            bindNode(*child, interner, &inner);
+        }
+        std::sort(inner.begin(), inner.end());
+        inner.erase(std::unique(inner.begin(), inner.end()), inner.end());
+        auto isParam = [&](uint32_t id) {
+            return id == node.restId || id == node.kwargsId ||
+                   std::find(node.nameIds.begin(), node.nameIds.end(), id) !=
+                       node.nameIds.end();
+        };
+        inner.erase(std::remove_if(inner.begin(), inner.end(), isParam), inner.end());
+        if (names) names->insert(names->end(), inner.begin(), inner.end());
+        node.freeNames = std::move(inner);
+        return;
+    }
+
+    if (names) {
+        if (node.kind == AstNodeKind::Name) names->push_back(node.symbolId);
+        if (node.kind == AstNodeKind::Set && !node.nameIds.empty()) names->push_back(node.nameIds[0]);
+    }
+    for (auto& child : node.children) {
+        bindNode(*child, interner, names);
+    }
+}
+
+void bindSymbols(AstNode& root, Interner& interner) {
+    bindNode(root, interner, nullptr);
+    root.boundInterner = &interner;
+}
+
+} // namespace finescript
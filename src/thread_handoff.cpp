@@ -0,0 +1,87 @@
+#include "finescript/thread_handoff.h"
+#include "finescript/map_data.h"
+#include <stdexcept>
+#include <unordered_map>
+
+namespace finescript {
+
+namespace {
+
+/// Deep copy that maps each source object to exactly one copy, so aliasing
+/// and cycles inside the value survive the handoff.
+class HandoffCopier {
+public:
+    Value copy(const Value& value) {
+        switch (value.type()) {
+            case Value::Type::Nil:
+            case Value::Type::Bool:
+            case Value::Type::Int:
+            case Value::Type::Float:
+            case Value::Type::Symbol:
+                return value;
+            case Value::Type::String: {
+                auto& src = value.asString();
+                if (auto* seen = find(&src)) return *seen;
+                return copies_[&src] = Value::string(src);
+            }
+            case Value::Type::Array: {
+                if (auto* r = value.lazyRange()) {
+                    if (auto* seen = find(r)) return *seen;
+                    return copies_[r] = Value::range(r->start, r->end);
+                }
+                auto& src = value.asArray();
+                if (auto* seen = find(&src)) return *seen;
+                Value result = copies_[&src] = Value::array(std::vector<Value>());
+                auto& dst = result.asArrayMut();
+                dst.reserve(src.size());
+                for (auto& elem : src) dst.push_back(copy(elem));
+                return result;
+            }
+            case Value::Type::Map: {
+                auto& src = value.asMap();
+                if (src.isProxy()) {
+                    throw std::runtime_error("Cannot hand a proxy map to another thread");
+                }
+                if (auto* seen = find(&src)) return *seen;
+                Value result = copies_[&src] = Value::map();
+                auto& dst = result.asMap();
+                src.forEach([&](uint32_t key, const Value& elem) {
+                    if (src.isMethod(key)) {
+                        dst.setMethod(key, copy(elem));
+                    } else {
+                        dst.set(key, copy(elem));
+                    }
+                });
+                return result;
+            }
+            case Value::Type::Closure:
+            case Value::Type::NativeFunction:
+                throw std::runtime_error("Cannot hand a function to another thread");
+        }
+        return Value::nil();
+    }
+
+private:
+    std::unordered_map<const void*, Value> copies_;
+
+    const Value* find(const void* source) const {
+        auto it = copies_.find(source);
+        return it != copies_.end() ? &it->second : nullptr;
+    }
+};
+
+} // anonymous namespace
+
+ThreadHandoff::ThreadHandoff(const Value& value) {
+    // The copier's table holds extra references; they are dropped here, on
+    // the sending thread, before the handoff leaves it.
+    value_ = HandoffCopier().copy(value);
+}
+
+Value ThreadHandoff::take() {
+    if (taken_) throw std::logic_error("ThreadHandoff value already taken");
+    taken_ = true;
+    return std::move(value_);
+}
+
+} // namespace finescript
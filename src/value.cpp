@@ -32,179 +32,270 @@ std::string SourceLocation::toString() const {
            std::to_string(line) + ":" + std::to_string(column);
 }
 
+// -- Heap objects --
+
+namespace {
+
+struct StringObject : RefCounted {
+    std::string value;
+    bool shared = false;    // Value::sharedString: copied before mutation
+    explicit StringObject(std::string s) : value(std::move(s)) {}
+};
+
+struct ArrayObject : RefCounted {
+    std::vector<Value> value;
+    explicit ArrayObject(std::vector<Value> elems) : value(std::move(elems)) {}
+};
+
+} // anonymous namespace
+
+void Value::adoptShared(uint8_t tag, RefCounted* obj, std::shared_ptr<void> owner) {
+    if (!obj) throw std::runtime_error("Cannot make a value from a null pointer");
+    // An object no Value refers to has no owner_ yet; the first reference
+    // takes the caller's shared_ptr so the host and the script share it.
+    if (obj->refCount() == 0) obj->owner_ = std::move(owner);
+    adopt(tag, obj);
+}
+
+void Value::destroy() {
+    RefCounted* obj = p_.obj;
+    if (obj->owner_) {
+        // The shared_ptr owner frees the object once the host lets go too
+        auto owner = std::move(obj->owner_);
+        return;
+    }
+    switch (tag_) {
+        case static_cast<uint8_t>(Type::String): delete static_cast<StringObject*>(obj); break;
+        case static_cast<uint8_t>(Type::Array): delete static_cast<ArrayObject*>(obj); break;
+        case static_cast<uint8_t>(Type::Map): delete static_cast<MapData*>(obj); break;
+        case static_cast<uint8_t>(Type::Closure): delete static_cast<Closure*>(obj); break;
+        case static_cast<uint8_t>(Type::NativeFunction):
+            delete static_cast<NativeFunctionObject*>(obj);
+            break;
+        case kRange: delete static_cast<RangeData*>(obj); break;
+    }
+}
+
+const std::shared_ptr<void>& Value::sharedOwner() const {
+    RefCounted* obj = p_.obj;
+    if (!obj->owner_) {
+        // Hand ownership of a Value-allocated object to a shared_ptr; our
+        // reference keeps it alive until destroy() drops the owner again.
+        switch (tag_) {
+            case static_cast<uint8_t>(Type::String):
+                obj->owner_ = std::shared_ptr<StringObject>(static_cast<StringObject*>(obj));
+                break;
+            case static_cast<uint8_t>(Type::Array):
+                obj->owner_ = std::shared_ptr<ArrayObject>(static_cast<ArrayObject*>(obj));
+                break;
+            case static_cast<uint8_t>(Type::Map):
+                obj->owner_ = std::shared_ptr<MapData>(static_cast<MapData*>(obj));
+                break;
+        }
+    }
+    return obj->owner_;
+}
+
+void Value::typeMismatch(const char* expected) const {
+    throw std::runtime_error(std::string("Value is not ") + expected + ", got " + typeName());
+}
+
 // -- Value static factories --
 
 Value Value::nil() { return Value(); }
 
 Value Value::boolean(bool b) {
     Value v;
-    v.data_ = b;
+    v.p_.b = b;
+    v.tag_ = kBool;
     return v;
 }
 
 Value Value::integer(int64_t i) {
     Value v;
-    v.data_ = i;
+    v.p_.i = i;
+    v.tag_ = static_cast<uint8_t>(Type::Int);
     return v;
 }
 
 Value Value::number(double d) {
     Value v;
-    v.data_ = d;
+    v.p_.d = d;
+    v.tag_ = static_cast<uint8_t>(Type::Float);
     return v;
 }
 
 Value Value::symbol(uint32_t id) {
     Value v;
-    v.data_ = id;
+    v.p_.sym = id;
+    v.tag_ = static_cast<uint8_t>(Type::Symbol);
     return v;
 }
 
 Value Value::string(std::string s) {
     Value v;
-    v.data_ = std::make_shared<std::string>(std::move(s));
+    v.adopt(static_cast<uint8_t>(Type::String), new StringObject(std::move(s)));
     return v;
 }
 
-Value Value::string(std::shared_ptr<std::string> s) {
-    Value v;
-    v.data_ = std::move(s);
+Value Value::sharedString(std::string s) {
+    Value v = string(std::move(s));
+    static_cast<StringObject*>(v.p_.obj)->shared = true;
     return v;
 }
 
+Value Value::string(std::shared_ptr<std::string> s) {
+    if (!s) throw std::runtime_error("Cannot make a value from a null pointer");
+    return string(s.use_count() == 1 ? std::move(*s) : *s);
+}
+
 Value Value::array(std::vector<Value> elems) {
     Value v;
-    v.data_ = std::make_shared<std::vector<Value>>(std::move(elems));
+    v.adopt(static_cast<uint8_t>(Type::Array), new ArrayObject(std::move(elems)));
     return v;
 }
 
 Value Value::array(std::shared_ptr<std::vector<Value>> a) {
+    if (!a) throw std::runtime_error("Cannot make a value from a null pointer");
+    return array(a.use_count() == 1 ? std::move(*a) : *a);
+}
+
+Value Value::range(int64_t start, int64_t end) {
+    auto* r = new RangeData();
+    r->start = start;
+    r->end = end;
     Value v;
-    v.data_ = std::move(a);
+    v.adopt(kRange, r);
     return v;
 }
 
 Value Value::map() {
     Value v;
-    v.data_ = std::make_shared<MapData>();
+    v.adopt(static_cast<uint8_t>(Type::Map), new MapData());
     return v;
 }
 
 Value Value::map(std::shared_ptr<MapData> data) {
     Value v;
-    v.data_ = std::move(data);
+    RefCounted* obj = data.get();
+    v.adoptShared(static_cast<uint8_t>(Type::Map), obj, std::move(data));
     return v;
 }
 
 Value Value::proxyMap(std::shared_ptr<ProxyMap> proxy) {
     Value v;
-    v.data_ = std::make_shared<MapData>(std::move(proxy));
+    v.adopt(static_cast<uint8_t>(Type::Map), new MapData(std::move(proxy)));
     return v;
 }
 
 Value Value::closure(std::shared_ptr<Closure> c) {
     Value v;
-    v.data_ = std::move(c);
+    RefCounted* obj = c.get();
+    v.adoptShared(static_cast<uint8_t>(Type::Closure), obj, std::move(c));
     return v;
 }
 
 Value Value::nativeFunction(std::shared_ptr<NativeFunctionObject> f) {
     Value v;
-    v.data_ = std::move(f);
+    RefCounted* obj = f.get();
+    v.adoptShared(static_cast<uint8_t>(Type::NativeFunction), obj, std::move(f));
     return v;
 }
 
 // -- Accessors --
 
-bool Value::asBool() const {
-    if (auto* p = std::get_if<bool>(&data_)) return *p;
-    throw std::runtime_error("Value is not a bool, got " + typeName());
-}
-
-int64_t Value::asInt() const {
-    if (auto* p = std::get_if<int64_t>(&data_)) return *p;
-    throw std::runtime_error("Value is not an int, got " + typeName());
-}
-
-double Value::asFloat() const {
-    if (auto* p = std::get_if<double>(&data_)) return *p;
-    throw std::runtime_error("Value is not a float, got " + typeName());
-}
-
-double Value::asNumber() const {
-    if (auto* p = std::get_if<int64_t>(&data_)) return static_cast<double>(*p);
-    if (auto* p = std::get_if<double>(&data_)) return *p;
-    throw std::runtime_error("Value is not numeric, got " + typeName());
+const std::string& Value::asString() const {
+    if (isString()) return static_cast<StringObject*>(p_.obj)->value;
+    typeMismatch("a string");
 }
 
-uint32_t Value::asSymbol() const {
-    if (auto* p = std::get_if<uint32_t>(&data_)) return *p;
-    throw std::runtime_error("Value is not a symbol, got " + typeName());
+std::string& Value::asStringMut() {
+    if (!isString()) typeMismatch("a string");
+    auto* obj = static_cast<StringObject*>(p_.obj);
+    if (obj->shared) {
+        *this = string(obj->value);
+        obj = static_cast<StringObject*>(p_.obj);
+    }
+    return obj->value;
 }
 
-const std::string& Value::asString() const {
-    if (auto* p = std::get_if<std::shared_ptr<std::string>>(&data_)) return **p;
-    throw std::runtime_error("Value is not a string, got " + typeName());
+bool Value::appendInPlace(Value& held, std::string_view suffix) {
+    if (!isString() || held.tag_ != tag_ || held.p_.obj != p_.obj) return false;
+    auto* obj = static_cast<StringObject*>(p_.obj);
+    if (obj->shared || obj->owner_ || obj->refCount() != 2) return false;
+    held = Value();
+    obj->value.append(suffix);   // std::string growth makes repeated appends amortized O(1)
+    return true;
 }
 
-std::string& Value::asStringMut() {
-    if (auto* p = std::get_if<std::shared_ptr<std::string>>(&data_)) return **p;
-    throw std::runtime_error("Value is not a string, got " + typeName());
+// Build the element array of a range once; later calls return the same one.
+static const Value& materialize(RangeData& range) {
+    if (range.ready.load(std::memory_order_acquire)) return range.elements;
+    std::call_once(range.once, [&] {
+        std::vector<Value> elems;
+        elems.reserve(static_cast<size_t>(range.size()));
+        for (int64_t i = range.start; i < range.end; i++) {
+            elems.push_back(Value::integer(i));
+        }
+        range.elements = Value::array(std::move(elems));
+        range.ready.store(true, std::memory_order_release);
+    });
+    return range.elements;
 }
 
 const std::vector<Value>& Value::asArray() const {
-    if (auto* p = std::get_if<std::shared_ptr<std::vector<Value>>>(&data_)) return **p;
-    throw std::runtime_error("Value is not an array, got " + typeName());
+    if (is(Type::Array)) return static_cast<ArrayObject*>(p_.obj)->value;
+    if (tag_ == kRange) return materialize(*static_cast<RangeData*>(p_.obj)).asArray();
+    typeMismatch("an array");
 }
 
 std::vector<Value>& Value::asArrayMut() {
-    if (auto* p = std::get_if<std::shared_ptr<std::vector<Value>>>(&data_)) return **p;
-    throw std::runtime_error("Value is not an array, got " + typeName());
+    if (tag_ == kRange) {
+        // Other copies keep the RangeData and see the same elements
+        *this = materialize(*static_cast<RangeData*>(p_.obj));
+    }
+    if (is(Type::Array)) return static_cast<ArrayObject*>(p_.obj)->value;
+    typeMismatch("an array");
 }
 
 MapData& Value::asMap() {
-    if (auto* p = std::get_if<std::shared_ptr<MapData>>(&data_)) return **p;
-    throw std::runtime_error("Value is not a map, got " + typeName());
+    if (isMap()) return *static_cast<MapData*>(p_.obj);
+    typeMismatch("a map");
 }
 
 const MapData& Value::asMap() const {
-    if (auto* p = std::get_if<std::shared_ptr<MapData>>(&data_)) return **p;
-    throw std::runtime_error("Value is not a map, got " + typeName());
+    if (isMap()) return *static_cast<const MapData*>(p_.obj);
+    typeMismatch("a map");
 }
 
 Closure& Value::asClosure() {
-    if (auto* p = std::get_if<std::shared_ptr<Closure>>(&data_)) return **p;
-    throw std::runtime_error("Value is not a closure, got " + typeName());
+    if (isClosure()) return *static_cast<Closure*>(p_.obj);
+    typeMismatch("a closure");
 }
 
 const Closure& Value::asClosure() const {
-    if (auto* p = std::get_if<std::shared_ptr<Closure>>(&data_)) return **p;
-    throw std::runtime_error("Value is not a closure, got " + typeName());
+    if (isClosure()) return *static_cast<const Closure*>(p_.obj);
+    typeMismatch("a closure");
 }
 
 NativeFunctionObject& Value::asNativeFunction() {
-    if (auto* p = std::get_if<std::shared_ptr<NativeFunctionObject>>(&data_)) return **p;
-    throw std::runtime_error("Value is not a native function, got " + typeName());
+    if (isNativeFunction()) return *static_cast<NativeFunctionObject*>(p_.obj);
+    typeMismatch("a native function");
 }
 
-std::shared_ptr<std::string>& Value::stringPtr() {
-    return std::get<std::shared_ptr<std::string>>(data_);
+std::shared_ptr<std::string> Value::stringPtr() {
+    auto& str = asStringMut();
+    return std::shared_ptr<std::string>(sharedOwner(), &str);
 }
 
-std::shared_ptr<std::vector<Value>>& Value::arrayPtr() {
-    return std::get<std::shared_ptr<std::vector<Value>>>(data_);
+std::shared_ptr<std::vector<Value>> Value::arrayPtr() {
+    auto& arr = asArrayMut();
+    return std::shared_ptr<std::vector<Value>>(sharedOwner(), &arr);
 }
 
-std::shared_ptr<MapData>& Value::mapPtr() {
-    return std::get<std::shared_ptr<MapData>>(data_);
-}
-
-// -- Truthiness --
-
-bool Value::truthy() const {
-    if (isNil()) return false;
-    if (isBool()) return asBool();
-    return true;
+std::shared_ptr<MapData> Value::mapPtr() {
+    auto& map = asMap();
+    return std::shared_ptr<MapData>(sharedOwner(), &map);
 }
 
 // -- Equality --
@@ -220,6 +311,23 @@ bool Value::operator==(const Value& other) const {
         case Type::Symbol: return asSymbol() == other.asSymbol();
         case Type::String: return asString() == other.asString();
         case Type::Array: {
+            auto* ra = lazyRange();
+            auto* rb = other.lazyRange();
+            if (ra && rb) {
+                return ra->size() == rb->size() && (ra->size() == 0 || ra->start == rb->start);
+            }
+            if (ra || rb) {
+                // Compare element-wise without materializing the range
+                const RangeData& r = ra ? *ra : *rb;
+                auto& arr = ra ? other.asArray() : asArray();
+                if (static_cast<int64_t>(arr.size()) != r.size()) return false;
+                for (size_t i = 0; i < arr.size(); i++) {
+                    if (!arr[i].isInt() || arr[i].asInt() != r.start + static_cast<int64_t>(i)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
             auto& a = asArray();
             auto& b = other.asArray();
             if (a.size() != b.size()) return false;
@@ -230,14 +338,9 @@ bool Value::operator==(const Value& other) const {
         }
         // Maps, closures, native functions compared by identity
         case Type::Map:
-            return std::get<std::shared_ptr<MapData>>(data_).get() ==
-                   std::get<std::shared_ptr<MapData>>(other.data_).get();
         case Type::Closure:
-            return std::get<std::shared_ptr<Closure>>(data_).get() ==
-                   std::get<std::shared_ptr<Closure>>(other.data_).get();
         case Type::NativeFunction:
-            return std::get<std::shared_ptr<NativeFunctionObject>>(data_).get() ==
-                   std::get<std::shared_ptr<NativeFunctionObject>>(other.data_).get();
+            return p_.obj == other.p_.obj;
     }
     return false;
 }
@@ -278,6 +381,13 @@ std::string Value::toString(Interner* interner) const {
         case Type::String: return asString();
         case Type::Array: {
             std::string result = "[";
+            if (auto* r = lazyRange()) {
+                for (int64_t i = r->start; i < r->end; i++) {
+                    if (i > r->start) result += " ";
+                    result += std::to_string(i);
+                }
+                return result + "]";
+            }
             auto& arr = asArray();
             for (size_t i = 0; i < arr.size(); i++) {
                 if (i > 0) result += " ";
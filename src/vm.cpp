@@ -0,0 +1,636 @@
+#include "finescript/evaluator.h"
+#include "finescript/compiler.h"
+#include "finescript/ast.h"
+#include "finescript/interner.h"
+#include "finescript/error.h"
+#include "finescript/map_data.h"
+#include "finescript/execution_context.h"
+#include "finescript/script_engine.h"
+
+namespace finescript {
+
+namespace {
+
+/// Releases a frame's registers however the frame exits.
+struct FrameGuard {
+    RegisterStack& stack;
+    Value* base;
+    size_t count;
+    ~FrameGuard() { stack.pop(base, count); }
+};
+
+/// The slot an OuterRef names, or nullptr if the by-name path must be
+/// taken: the slot is unbound, or a scope in between holds dynamic
+/// bindings that might shadow it.
+Value* outerSlot(Scope* scope, const OuterRef& ref) {
+    for (uint16_t i = 0; i < ref.depth; i++) {
+        if (scope->hasDynamicBindings()) return nullptr;
+        scope = scope->parent().get();
+    }
+    return scope->slot(ref.slot);
+}
+
+/// Output size of interpolating `parts`: exact for strings, a guess for
+/// values that still have to be formatted.
+size_t interpolatedSize(const Value* parts, size_t count) {
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        size += parts[i].isString() ? parts[i].asString().size() : 16;
+    }
+    return size;
+}
+
+/// The variable `store` (a SetLocal, SetOuter or SetName) writes to, if it
+/// is bound.
+Value* storeTarget(Scope* scope, const Chunk& chunk, const Instruction& store) {
+    const uint32_t* syms = chunk.symbols.data();
+    switch (store.op) {
+        case OpCode::SetLocal:
+            if (Value* v = scope->slot(store.b)) return v;
+            return scope->lookup(syms[store.c]);
+        case OpCode::SetOuter: {
+            const OuterRef& ref = chunk.outerRefs[store.b];
+            if (Value* v = outerSlot(scope, ref)) return v;
+            return scope->lookup(syms[ref.sym]);
+        }
+        case OpCode::SetName:
+            return scope->lookup(syms[store.b]);
+        default:
+            return nullptr;
+    }
+}
+
+} // anonymous namespace
+
+Value Evaluator::execute(std::shared_ptr<AstNode> root, std::shared_ptr<Scope> scope,
+                         ExecutionContext* ctx) {
+    auto chunk = Compiler::compile(root, interner_);
+    return run(*chunk, std::move(scope), ctx);
+}
+
+Value Evaluator::run(const Chunk& chunk, std::shared_ptr<Scope> scope, ExecutionContext* ctx) {
+    bool returned = false;
+    return runFrame(chunk, std::move(scope), ctx, returned);
+}
+
+Value Evaluator::runFrame(const Chunk& chunk, std::shared_ptr<Scope> frameScope,
+                          ExecutionContext* ctx, bool& returned) {
+    Value* regs = registers_.push(chunk.numRegisters);
+    FrameGuard guard{registers_, regs, chunk.numRegisters};
+
+    // Innermost scope; `for` loops push child scopes on top of the frame's scope
+    std::shared_ptr<Scope> scopeHolder = std::move(frameScope);
+    std::vector<std::shared_ptr<Scope>> outerScopes;
+    // Live `for` loops over proxy maps, indexed by their cursor register
+    std::vector<std::unique_ptr<ProxyMap::Iterator>> proxyIters;
+    Value scratch;
+
+    const Instruction* code = chunk.code.data();
+    const uint32_t* syms = chunk.symbols.data();
+    size_t pc = 0;
+    auto loc = [&]() { return chunk.locations[pc - 1]; };
+
+    while (true) {
+        const Instruction& ins = code[pc++];
+        Scope* scope = scopeHolder.get();
+
+        switch (ins.op) {
+            case OpCode::LoadConst:
+                regs[ins.a] = chunk.constants[ins.bx()];
+                break;
+            case OpCode::LoadInt:
+                regs[ins.a] = Value::integer(static_cast<int32_t>(ins.bx()));
+                break;
+            case OpCode::LoadString:
+                regs[ins.a] = Value::string(chunk.constants[ins.bx()].asString());
+                break;
+            case OpCode::LoadNil:
+                regs[ins.a] = Value::nil();
+                break;
+            case OpCode::LoadBool:
+                regs[ins.a] = Value::boolean(ins.b != 0);
+                break;
+            case OpCode::Move:
+                regs[ins.a] = regs[ins.b];
+                break;
+
+            // -- Names --
+
+            case OpCode::GetName: {
+                Value* v = scope->lookup(syms[ins.b]);
+                regs[ins.a] = v ? *v : Value::nil(); // unbound = nil
+                break;
+            }
+            case OpCode::GetNameStrict: {
+                Value* v = scope->lookup(syms[ins.b]);
+                if (!v) {
+                    throw ScriptError("Undefined variable '" +
+                        std::string(interner_.lookup(syms[ins.b])) + "'", loc());
+                }
+                regs[ins.a] = *v;
+                break;
+            }
+            case OpCode::SetName:
+                scope->set(syms[ins.b], regs[ins.a]);
+                break;
+            case OpCode::DefineName:
+                scope->define(syms[ins.b], regs[ins.a]);
+                break;
+            case OpCode::GetLocal: {
+                Value* v = scope->slot(ins.b);
+                if (!v) v = scope->lookup(syms[ins.c]);
+                regs[ins.a] = v ? *v : Value::nil();
+                break;
+            }
+            case OpCode::SetLocal:
+                if (Value* v = scope->slot(ins.b)) *v = regs[ins.a];
+                else scope->set(syms[ins.c], regs[ins.a]);
+                break;
+            case OpCode::DefineLocal:
+                scope->bindSlot(ins.b, regs[ins.a]);
+                break;
+            case OpCode::GetOuter: {
+                const OuterRef& ref = chunk.outerRefs[ins.b];
+                Value* v = outerSlot(scope, ref);
+                if (!v) v = scope->lookup(syms[ref.sym]);
+                regs[ins.a] = v ? *v : Value::nil();
+                break;
+            }
+            case OpCode::SetOuter: {
+                const OuterRef& ref = chunk.outerRefs[ins.b];
+                if (Value* v = outerSlot(scope, ref)) *v = regs[ins.a];
+                else scope->set(syms[ref.sym], regs[ins.a]);
+                break;
+            }
+
+            // -- Fields and indexing --
+
+            case OpCode::GetField: {
+                const FieldSite& field = chunk.fields[ins.c];
+                regs[ins.a] = getField(regs[ins.b], syms[field.sym], loc(), &field.cache);
+                break;
+            }
+            case OpCode::GetMember: {
+                const FieldSite& field = chunk.fields[ins.c];
+                const Value& obj = regs[ins.b];
+                if (!obj.isMap()) {
+                    throw ScriptError("Cannot access field '" +
+                        std::string(interner_.lookup(syms[field.sym])) + "' on " +
+                        obj.typeName(), loc());
+                }
+                regs[ins.a] = obj.asMap().get(syms[field.sym], field.cache);
+                break;
+            }
+            case OpCode::SetField: {
+                const FieldSite& field = chunk.fields[ins.c];
+                Value& obj = regs[ins.a];
+                if (!obj.isMap()) {
+                    throw ScriptError("Cannot set field on " + obj.typeName(), loc());
+                }
+                obj.asMap().set(syms[field.sym], regs[ins.b], field.cache);
+                // Auto-detect methods: closures with first param named "self"
+                if (isAutoMethod(regs[ins.b])) {
+                    obj.asMap().markMethod(syms[field.sym]);
+                }
+                break;
+            }
+            case OpCode::Index: {
+                const Value& target = regs[ins.b];
+                const Value& index = regs[ins.c];
+                if (target.isArray() && index.isInt() && !target.lazyRange()) {
+                    auto& arr = target.asArray();
+                    int64_t idx = index.asInt();
+                    if (idx < 0) idx += static_cast<int64_t>(arr.size());
+                    if (idx >= 0 && idx < static_cast<int64_t>(arr.size())) {
+                        regs[ins.a] = arr[static_cast<size_t>(idx)];
+                        break;
+                    }
+                }
+                regs[ins.a] = indexValue(target, index, loc());
+                break;
+            }
+
+            // -- Arithmetic and comparison (int fast paths) --
+
+            case OpCode::Add: {
+                const Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::integer(l.asInt() + r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Add, l, r, loc());
+                break;
+            }
+            case OpCode::Append: {
+                // set s (s + x): the next instruction stores R[a] back into s
+                Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isString() && r.isString()) {
+                    Value* target = storeTarget(scope, chunk, code[pc]);
+                    if (target && target->appendInPlace(l, r.asString())) {
+                        regs[ins.a] = *target;
+                        break;
+                    }
+                }
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::integer(l.asInt() + r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Add, l, r, loc());
+                break;
+            }
+            case OpCode::Sub: {
+                const Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::integer(l.asInt() - r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Sub, l, r, loc());
+                break;
+            }
+            case OpCode::Mul: {
+                const Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::integer(l.asInt() * r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Mul, l, r, loc());
+                break;
+            }
+            case OpCode::Div:
+                regs[ins.a] = applyBinOp(BinaryOp::Div, regs[ins.b], regs[ins.c], loc());
+                break;
+            case OpCode::Mod:
+                regs[ins.a] = applyBinOp(BinaryOp::Mod, regs[ins.b], regs[ins.c], loc());
+                break;
+            case OpCode::Eq:
+                regs[ins.a] = Value::boolean(regs[ins.b] == regs[ins.c]);
+                break;
+            case OpCode::Ne:
+                regs[ins.a] = Value::boolean(regs[ins.b] != regs[ins.c]);
+                break;
+            case OpCode::Lt: {
+                const Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::boolean(l.asInt() < r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Lt, l, r, loc());
+                break;
+            }
+            case OpCode::Gt: {
+                const Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::boolean(l.asInt() > r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Gt, l, r, loc());
+                break;
+            }
+            case OpCode::Le: {
+                const Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::boolean(l.asInt() <= r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Le, l, r, loc());
+                break;
+            }
+            case OpCode::Ge: {
+                const Value& l = regs[ins.b];
+                const Value& r = regs[ins.c];
+                if (l.isInt() && r.isInt()) regs[ins.a] = Value::boolean(l.asInt() >= r.asInt());
+                else regs[ins.a] = applyBinOp(BinaryOp::Ge, l, r, loc());
+                break;
+            }
+            case OpCode::Range:
+                regs[ins.a] = applyBinOp(BinaryOp::Range, regs[ins.b], regs[ins.c], loc());
+                break;
+            case OpCode::RangeIncl:
+                regs[ins.a] = applyBinOp(BinaryOp::RangeIncl, regs[ins.b], regs[ins.c], loc());
+                break;
+            case OpCode::Not:
+                regs[ins.a] = Value::boolean(!regs[ins.b].truthy());
+                break;
+            case OpCode::Negate: {
+                const Value& v = regs[ins.b];
+                if (v.isInt()) regs[ins.a] = Value::integer(-v.asInt());
+                else if (v.isFloat()) regs[ins.a] = Value::number(-v.asFloat());
+                else throw ScriptError("Cannot negate " + v.typeName(), loc());
+                break;
+            }
+
+            // -- Control flow --
+
+            case OpCode::Jump:
+                pc = ins.bx();
+                break;
+            case OpCode::JumpIfFalse:
+                if (!regs[ins.a].truthy()) pc = ins.bx();
+                break;
+            case OpCode::JumpIfTrue:
+                if (regs[ins.a].truthy()) pc = ins.bx();
+                break;
+            case OpCode::JumpIfNotNil:
+                if (!regs[ins.a].isNil()) pc = ins.bx();
+                break;
+
+            // -- Constructors --
+
+            case OpCode::NewArray:
+                regs[ins.a] = Value::array(std::vector<Value>(regs + ins.b, regs + ins.b + ins.c));
+                break;
+            case OpCode::NewMap:
+                regs[ins.a] = Value::map();
+                break;
+            case OpCode::MapSet: {
+                MapData& map = regs[ins.a].asMap();
+                map.set(syms[ins.c], regs[ins.b]);
+                // Auto-detect methods: closures with first param named "self"
+                if (isAutoMethod(regs[ins.b])) {
+                    map.markMethod(syms[ins.c]);
+                }
+                break;
+            }
+            case OpCode::Concat: {
+                std::string result;
+                result.reserve(interpolatedSize(regs + ins.b, ins.c));
+                for (uint16_t i = 0; i < ins.c; i++) {
+                    const Value& part = regs[ins.b + i];
+                    if (part.isString()) result += part.asString();
+                    else result += part.toString(&interner_);
+                }
+                regs[ins.a] = Value::string(std::move(result));
+                break;
+            }
+
+            case OpCode::AppendConcat: {
+                std::string suffix;
+                suffix.reserve(interpolatedSize(regs + ins.b, ins.c));
+                for (uint16_t i = 0; i < ins.c; i++) {
+                    const Value& part = regs[ins.b + i];
+                    if (part.isString()) suffix += part.asString();
+                    else suffix += part.toString(&interner_);
+                }
+                Value& l = regs[ins.a];
+                if (!l.isString()) {
+                    l = Value::string(l.toString(&interner_) + suffix);
+                    break;
+                }
+                Value* target = storeTarget(scope, chunk, code[pc]);
+                if (target && target->appendInPlace(l, suffix)) {
+                    l = *target;
+                } else {
+                    l = Value::string(l.asString() + suffix);
+                }
+                break;
+            }
+
+            // -- Calls --
+
+            case OpCode::Call: {
+                const Value& callee = regs[ins.b];
+                // Zero-arg call on non-callable: return the value
+                if (ins.c == 0 && !callee.isCallable()) {
+                    regs[ins.a] = callee;
+                    break;
+                }
+                regs[ins.a] = invoke(callee, ArgSpan(regs + ins.b + 1, ins.c), ctx, loc());
+                break;
+            }
+            case OpCode::CallNamed:
+                regs[ins.a] = callNamed(regs[ins.b], chunk, chunk.calls[ins.c],
+                                        regs + ins.b + 1, ctx, loc());
+                break;
+            case OpCode::CallMethod:
+                regs[ins.a] = callMethod(regs[ins.b], chunk, chunk.calls[ins.c],
+                                         regs + ins.b + 1, ctx, loc());
+                break;
+
+            // -- Closures and handlers --
+
+            case OpCode::MakeClosure: {
+                const auto& fnChunk = chunk.functions[ins.bx()];
+                const AstNode& node = *fnChunk->node;
+                auto closure = makeClosure(node, *scope);
+                closure->astRoot = chunk.astRoot;  // keeps AST alive
+                closure->chunk = fnChunk;
+                Value closureVal = Value::closure(std::move(closure));
+                // Named function: define in current scope
+                if (node.symbolId != kNoSymbol) {
+                    scope->define(node.symbolId, closureVal);
+                }
+                regs[ins.a] = std::move(closureVal);
+                break;
+            }
+            case OpCode::OnHandler: {
+                const auto& fnChunk = chunk.functions[ins.bx()];
+                const AstNode& node = *fnChunk->node;
+                if (!ctx) {
+                    throw ScriptError("'on' requires an execution context", loc());
+                }
+                auto closure = std::make_shared<Closure>();
+                closure->name = fnChunk->name;
+                closure->body = node.children[0].get();
+                closure->astRoot = chunk.astRoot;  // keeps AST alive
+                closure->chunk = fnChunk;
+                closure->capturedScope = scopeHolder;
+                ctx->registerEventHandler(node.symbolId,
+                                          Value::closure(std::move(closure)));
+                regs[ins.a] = Value::nil();
+                break;
+            }
+
+            // -- Scopes and loops --
+
+            case OpCode::PushScope: {
+                auto child = scope->createFrame(chunk.scopeLayouts[ins.bx()]);
+                outerScopes.push_back(std::move(scopeHolder));
+                scopeHolder = std::move(child);
+                break;
+            }
+            case OpCode::PopScope:
+                scopeHolder = std::move(outerScopes.back());
+                outerScopes.pop_back();
+                break;
+            case OpCode::ForPrep: {
+                const Value& iterable = regs[ins.a];
+                if (iterable.isMap() && iterable.asMap().isProxy()) {
+                    // The cursor register indexes this frame's proxy iterators
+                    regs[ins.a + 1] = Value::integer(static_cast<int64_t>(proxyIters.size()));
+                    proxyIters.push_back(iterable.asMap().proxy()->iterate());
+                    break;
+                }
+                if (!iterable.isArray() && !iterable.isString() && !iterable.isMap()) {
+                    throw ScriptError("Cannot iterate over " + iterable.typeName(), loc());
+                }
+                regs[ins.a + 1] = Value::integer(0);
+                break;
+            }
+            case OpCode::ForNext:
+            case OpCode::ForNextPair: {
+                const Value& iterable = regs[ins.a];
+                int64_t i = regs[ins.a + 1].asInt();
+                bool pairs = ins.op == OpCode::ForNextPair;
+                if (!pairs) {
+                    // Fast paths for counting loops and arrays
+                    if (auto* range = iterable.lazyRange()) {
+                        if (i < range->size()) {
+                            regs[ins.a + 2] = Value::integer(range->start + i);
+                            regs[ins.a + 1] = Value::integer(i + 1);
+                        } else {
+                            pc = ins.bx();
+                        }
+                        break;
+                    }
+                    if (iterable.isArray()) {
+                        const auto& arr = iterable.asArray();
+                        if (i < static_cast<int64_t>(arr.size())) {
+                            regs[ins.a + 2] = arr[static_cast<size_t>(i)];
+                            regs[ins.a + 1] = Value::integer(i + 1);
+                        } else {
+                            pc = ins.bx();
+                        }
+                        break;
+                    }
+                }
+                if (iterable.isMap() && iterable.asMap().isProxy()) {
+                    auto& it = proxyIters[static_cast<size_t>(i)];
+                    uint32_t key;
+                    if (it->next(key, pairs ? regs[ins.a + 2] : scratch)) {
+                        regs[ins.a + (pairs ? 3 : 2)] = Value::symbol(key);
+                    } else {
+                        it.reset();
+                        while (!proxyIters.empty() && !proxyIters.back()) proxyIters.pop_back();
+                        pc = ins.bx();
+                    }
+                    break;
+                }
+                auto cursor = static_cast<size_t>(i);
+                if (forStep(iterable, cursor, regs[ins.a + 2], pairs ? &regs[ins.a + 3] : nullptr)) {
+                    regs[ins.a + 1] = Value::integer(static_cast<int64_t>(cursor));
+                } else {
+                    pc = ins.bx();
+                }
+                break;
+            }
+
+            // -- Source and return --
+
+            case OpCode::Source: {
+                if (!engine_) {
+                    throw ScriptError("'source' not available (no ScriptEngine configured)", loc());
+                }
+                const Value& filenameVal = regs[ins.b];
+                if (!filenameVal.isString()) {
+                    throw ScriptError("source requires a string filename", loc());
+                }
+                auto resolved = engine_->resolveScript(filenameVal.asString());
+                if (resolved.empty()) {
+                    throw ScriptError("Cannot resolve script: " + filenameVal.asString(), loc());
+                }
+                auto sourced = engine_->bytecode(*engine_->loadScript(resolved));
+
+                // Execute in the current scope (like bash source). A `return`
+                // inside the sourced script returns from this frame too.
+                bool sourcedReturned = false;
+                Value result = runFrame(*sourced, scopeHolder, ctx, sourcedReturned);
+                if (sourcedReturned) {
+                    returned = true;
+                    return result;
+                }
+                regs[ins.a] = std::move(result);
+                break;
+            }
+            case OpCode::Return: {
+                returned = ins.c != 0;
+                Value result = std::move(regs[ins.a]);
+                return result;
+            }
+        }
+    }
+}
+
+Value Evaluator::callNamed(const Value& callee, const Chunk& chunk, const CallSite& site,
+                           const Value* args, ExecutionContext* ctx, SourceLocation loc) {
+    ArgSpan posArgs(args, site.numPositional);
+    const Value* named = args + site.numPositional;
+
+    // Named arg dispatch for closures
+    if (callee.isClosure()) {
+        std::vector<std::pair<uint32_t, Value>> namedArgs;
+        namedArgs.reserve(site.namedKeys.size());
+        for (size_t i = 0; i < site.namedKeys.size(); i++) {
+            namedArgs.push_back({chunk.symbols[site.namedKeys[i]], named[i]});
+        }
+        auto& closure = const_cast<Value&>(callee).asClosure();
+        return callClosureWithNamed(closure, posArgs, std::move(namedArgs), ctx, loc);
+    }
+
+    // Named arg dispatch for native functions: collect into kwargs map
+    if (callee.isNativeFunction()) {
+        auto kwargsMap = Value::map();
+        for (size_t i = 0; i < site.namedKeys.size(); i++) {
+            kwargsMap.asMap().set(chunk.symbols[site.namedKeys[i]], named[i]);
+        }
+        ArgBuffer withKwargs;
+        for (const auto& a : posArgs) withKwargs.push_back(a);
+        withKwargs.push_back(std::move(kwargsMap));
+        return invoke(callee, withKwargs, ctx, loc);
+    }
+
+    return invoke(callee, posArgs, ctx, loc);
+}
+
+Value Evaluator::callMethod(const Value& base, const Chunk& chunk, const CallSite& site,
+                            const Value* args, ExecutionContext* ctx, SourceLocation loc) {
+    size_t numNamed = site.namedKeys.size();
+
+    // Navigate through all but the last field to find the receiver
+    Value receiver = base;
+    for (size_t i = 0; i + 1 < site.path.size(); i++) {
+        uint32_t sym = chunk.symbols[site.path[i]];
+        if (!receiver.isMap()) {
+            throw ScriptError("Cannot access field '" + std::string(interner_.lookup(sym)) +
+                "' on " + receiver.typeName(), loc);
+        }
+        receiver = receiver.asMap().get(sym, site.pathCaches[i]);
+    }
+    uint32_t methodSym = chunk.symbols[site.path.back()];
+
+    ArgSpan posArgs(args, site.numPositional);
+
+    // Methods of the receiver's type (named args not supported for these)
+    if (const Method* method = findMethod(receiver, methodSym)) {
+        return invokeMethod(*method, receiver, posArgs, ctx, loc);
+    }
+
+    // Map field (user-defined method or stored function)
+    Value func;
+    bool passSelf = false;
+    if (receiver.isMap()) {
+        MapData& map = receiver.asMap();
+        if (map.lookup(methodSym, site.pathCaches.back(), func, passSelf)) {
+            if (!passSelf) {
+                // Zero-arg access on non-callable field: return value directly
+                if (posArgs.empty() && numNamed == 0 && !func.isCallable()) {
+                    return func;
+                }
+                if (numNamed > 0) return callNamed(func, chunk, site, args, ctx, loc);
+                return invoke(func, posArgs, ctx, loc);
+            }
+            // Auto-inject self as first argument; callNamed expects the
+            // positional args laid out before the named ones
+            ArgBuffer withSelf;
+            withSelf.push_back(receiver);
+            for (size_t i = 0; i < site.numPositional + numNamed; i++) withSelf.push_back(args[i]);
+            if (numNamed > 0) {
+                CallSite methodSite;
+                methodSite.numPositional = static_cast<uint16_t>(site.numPositional + 1);
+                methodSite.namedKeys = site.namedKeys;
+                return callNamed(func, chunk, methodSite, withSelf.data(), ctx, loc);
+            }
+            return invoke(func, withSelf, ctx, loc);
+        }
+    }
+
+    // Zero-arg call with no method found: fall back to property access
+    // along the whole dotted path
+    if (posArgs.empty() && numNamed == 0) {
+        Value current = base;
+        for (uint16_t symIdx : site.path) {
+            current = getField(current, chunk.symbols[symIdx], loc);
+        }
+        return current;
+    }
+
+    throw ScriptError("No method '" + std::string(interner_.lookup(methodSym)) +
+                      "' on " + receiver.typeName(), loc);
+}
+
+} // namespace finescript
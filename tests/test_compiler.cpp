@@ -0,0 +1,247 @@
+#include <catch2/catch_test_macros.hpp>
+#include "finescript/compiler.h"
+#include "finescript/evaluator.h"
+#include "finescript/parser.h"
+#include "finescript/interner.h"
+#include "finescript/error.h"
+#include "finescript/map_data.h"
+#include "finescript/script_engine.h"
+#include "finescript/execution_context.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+using namespace finescript;
+
+// Helper: compile a source string with a fresh interner
+struct CompileEnv {
+    DefaultInterner interner;
+    std::shared_ptr<Scope> globalScope = Scope::createGlobal();
+    Evaluator evaluator{interner, globalScope};
+
+    std::shared_ptr<const Chunk> compile(const std::string& source) {
+        auto ast = std::shared_ptr<AstNode>(Parser::parse(source).release());
+        return Compiler::compile(ast, interner);
+    }
+
+    // Evaluate with both the tree walker and the VM in separate scopes;
+    // the results must agree.
+    Value both(const std::string& source) {
+        auto ast = std::shared_ptr<AstNode>(Parser::parse(source).release());
+        Value walked = evaluator.eval(ast, globalScope->createChild());
+        Value executed = evaluator.execute(ast, globalScope->createChild());
+        CHECK(walked == executed);
+        return executed;
+    }
+};
+
+static std::vector<OpCode> opcodes(const Chunk& chunk) {
+    std::vector<OpCode> ops;
+    for (auto& ins : chunk.code) ops.push_back(ins.op);
+    return ops;
+}
+
+// === Code generation ===
+
+TEST_CASE("Compiler: integer arithmetic", "[compiler]") {
+    CompileEnv env;
+    auto chunk = env.compile("(1 + 2)");
+    CHECK(opcodes(*chunk) == std::vector<OpCode>{
+        OpCode::LoadInt, OpCode::LoadInt, OpCode::Add, OpCode::Return});
+    CHECK(chunk->interner == &env.interner);
+}
+
+TEST_CASE("Compiler: large integers go to the constant pool", "[compiler]") {
+    CompileEnv env;
+    auto chunk = env.compile("10000000000");
+    REQUIRE(chunk->code[0].op == OpCode::LoadConst);
+    CHECK(chunk->constants[chunk->code[0].bx()].asInt() == 10000000000LL);
+}
+
+TEST_CASE("Compiler: symbols are deduplicated", "[compiler]") {
+    CompileEnv env;
+    auto chunk = env.compile("set x 1\nset x (x + x)");
+    CHECK(chunk->symbols.size() == 1);
+    CHECK(chunk->symbols[0] == env.interner.intern("x"));
+}
+
+TEST_CASE("Compiler: fn bodies become nested chunks", "[compiler]") {
+    CompileEnv env;
+    auto chunk = env.compile("fn add [a b] (a + b)");
+    REQUIRE(chunk->functions.size() == 1);
+    CHECK(chunk->functions[0]->name == "add");
+    CHECK(opcodes(*chunk)[0] == OpCode::MakeClosure);
+}
+
+TEST_CASE("Compiler: disassemble lists every instruction", "[compiler]") {
+    CompileEnv env;
+    auto chunk = env.compile("fn f [] 1\nf");
+    auto text = disassemble(*chunk);
+    CHECK(text.find("MakeClosure") != std::string::npos);
+    CHECK(text.find("Call") != std::string::npos);
+    CHECK(text.find("; f (") != std::string::npos);
+}
+
+TEST_CASE("Compiler: locals and parameters resolve to slots", "[compiler]") {
+    CompileEnv env;
+    auto chunk = env.compile("fn f [a] do\n  let b (a + 1)\n  set c b\n  fn [] (a + c)\nend");
+    REQUIRE(chunk->functions.size() == 1);
+    auto& f = *chunk->functions[0];
+    REQUIRE(f.layout != nullptr);
+    CHECK(f.layout->names == std::vector<uint32_t>{
+        env.interner.intern("a"), env.interner.intern("b"), env.interner.intern("c")});
+    auto ops = opcodes(f);
+    CHECK(std::find(ops.begin(), ops.end(), OpCode::GetName) == ops.end());
+    CHECK(std::find(ops.begin(), ops.end(), OpCode::DefineLocal) != ops.end());
+
+    // The inner closure reaches a and c one scope up
+    auto& inner = *f.functions[0];
+    REQUIRE(inner.outerRefs.size() == 2);
+    CHECK(inner.outerRefs[0].depth == 1);
+}
+
+TEST_CASE("Compiler: script-level names stay dynamic", "[compiler]") {
+    CompileEnv env;
+    auto chunk = env.compile("set x 1\nlet y x");
+    CHECK(chunk->layout == nullptr);
+    CHECK(opcodes(*chunk) == std::vector<OpCode>{
+        OpCode::LoadInt, OpCode::SetName, OpCode::GetName, OpCode::DefineName, OpCode::Return});
+}
+
+// === VM vs tree walker ===
+
+TEST_CASE("VM: agrees with tree walker on control flow", "[compiler]") {
+    CompileEnv env;
+    CHECK(env.both("set s 0\nfor i in (0 .. 10) do\n  set s (s + i)\nend\ns").asInt() == 45);
+    CHECK(env.both("set n 0\nwhile (n < 5) do set n (n + 1) end\nn").asInt() == 5);
+    CHECK(env.both("match 3\n  1 \"one\"\n  3 \"three\"\n  _ \"other\"\nend").asString() == "three");
+    CHECK(env.both("if (1 > 2) do 10 elif (2 > 1) do 20 else do 30 end").asInt() == 20);
+    CHECK(env.both("(nil ?? 5)").asInt() == 5);
+    CHECK(env.both("(false or 7)").asInt() == 7);
+}
+
+TEST_CASE("VM: closures and early return", "[compiler]") {
+    CompileEnv env;
+    CHECK(env.both(
+        "fn find_first [arr target] do\n"
+        "  for x in arr do\n"
+        "    if (x == target) do return x end\n"
+        "  end\n"
+        "  nil\n"
+        "end\n"
+        "find_first [1 2 3] 2").asInt() == 2);
+    CHECK(env.both(
+        "fn make_counter [] do\n"
+        "  set n 0\n"
+        "  fn [] do set n (n + 1); n end\n"
+        "end\n"
+        "set c {make_counter}\n{c}\n{c}\n{c}").asInt() == 3);
+    CHECK(env.both("fn fib [n] do\n  if (n < 2) {return n}\n  ({fib (n - 1)} + {fib (n - 2)})\nend\nfib 15").asInt() == 610);
+}
+
+TEST_CASE("VM: maps, methods, and named args", "[compiler]") {
+    CompileEnv env;
+    CHECK(env.both("set m {=x 1 =y 2}\nset m.x 10\n(m.x + m.y)").asInt() == 12);
+    CHECK(env.both(
+        "set obj {=count 0 =inc fn [self n] do set self.count (self.count + n) end}\n"
+        "obj.inc 5\nobj.count").asInt() == 5);
+    CHECK(env.both("fn greet [name =greeting \"hi\"] \"{greeting} {name}\"\n"
+                   "{greet \"bob\" =greeting \"yo\"}").asString() == "yo bob");
+    CHECK(env.both("set a [3 1 2]\na.sort\n(a.length)").asInt() == 3);
+}
+
+TEST_CASE("VM: resolved names keep dynamic scoping semantics", "[compiler]") {
+    CompileEnv env;
+    // Read before let sees the outer binding; later iterations see the local
+    CHECK(env.both(
+        "set x 1\n"
+        "fn f [] do\n"
+        "  set seen []\n"
+        "  for i in [1 2] do\n"
+        "    seen.push x\n"
+        "    let x 10\n"
+        "  end\n"
+        "  seen.push x\n"
+        "  seen\n"
+        "end\n"
+        "{f}") == env.both("[1 10 1]"));
+    // set on a name bound further out updates it rather than creating a local
+    CHECK(env.both("set g 1\nfn bump [] {set g (g + 1)}\n{bump}\n{bump}\ng").asInt() == 3);
+    // Conditional let: unbound slot falls back to the enclosing binding
+    CHECK(env.both("set v 5\nfn h [flag] do\n  if flag {let v 6}\n  v\nend\n[{h false} {h true}]")
+          == env.both("[5 6]"));
+    // Closures share their enclosing function's slot
+    CHECK(env.both(
+        "fn pair [] do\n"
+        "  set n 0\n"
+        "  set inc fn [] {set n (n + 1)}\n"
+        "  set get fn [] n\n"
+        "  [inc get]\n"
+        "end\n"
+        "set p {pair}\n"
+        "set i (p[0])\nset g (p[1])\n{i}\n{i}\n{g}").asInt() == 2);
+}
+
+TEST_CASE("VM: names defined by source shadow resolved outer slots", "[compiler]") {
+    ScriptEngine engine;
+    ExecutionContext ctx(engine);
+    auto tmpFile = std::filesystem::temp_directory_path() / "finescript_slot_shadow.script";
+    {
+        std::ofstream out(tmpFile);
+        out << "let y 2\n";
+    }
+    auto result = engine.executeCommand(
+        "fn outer [] do\n"
+        "  let y 1\n"
+        "  fn inner [] do\n"
+        "    source \"" + tmpFile.string() + "\"\n"
+        "    y\n"
+        "  end\n"
+        "  {inner}\n"
+        "end\n"
+        "{outer}", ctx);
+    std::filesystem::remove(tmpFile);
+    REQUIRE(result.success);
+    CHECK(result.returnValue.asInt() == 2);
+}
+
+TEST_CASE("VM: closures created by the VM carry their chunk", "[compiler]") {
+    CompileEnv env;
+    Value f = env.evaluator.execute(
+        std::shared_ptr<AstNode>(Parser::parse("fn [x] (x * 2)").release()), env.globalScope);
+    REQUIRE(f.isClosure());
+    CHECK(f.asClosure().chunk != nullptr);
+    CHECK(env.evaluator.callFunction(f, {Value::integer(21)}, env.globalScope,
+                                     nullptr, SourceLocation{}).asInt() == 42);
+}
+
+TEST_CASE("VM: runtime errors carry source locations", "[compiler]") {
+    CompileEnv env;
+    auto ast = std::shared_ptr<AstNode>(Parser::parse("set x 1\n(x + [1])").release());
+    try {
+        env.evaluator.execute(ast, env.globalScope);
+        FAIL("expected ScriptError");
+    } catch (const ScriptError& e) {
+        CHECK(e.location().line == 2);
+    }
+}
+
+TEST_CASE("VM: deep recursion grows the register stack", "[compiler]") {
+    CompileEnv env;
+    CHECK(env.both("fn depth [n] do\n  if (n == 0) {return 0}\n  (1 + {depth (n - 1)})\nend\ndepth 500").asInt() == 500);
+}
+
+// === Engine integration ===
+
+TEST_CASE("ScriptEngine: bytecode is cached per script", "[compiler]") {
+    ScriptEngine engine;
+    auto script = engine.parseString("(1 + 2)");
+    auto first = engine.bytecode(*script);
+    CHECK(engine.bytecode(*script) == first);
+
+    DefaultInterner other;
+    engine.setInterner(&other);
+    auto recompiled = engine.bytecode(*script);
+    CHECK(recompiled != first);
+    CHECK(recompiled->interner == &other);
+}
@@ -7,7 +7,9 @@
 
 using namespace finescript;
 
-// Helper: parse + evaluate with a persistent scope (for multi-statement tests)
+// Helper: parse + evaluate with a persistent scope (for multi-statement tests).
+// Built twice: once against the tree walker, once (FINESCRIPT_TEST_BYTECODE)
+// against the bytecode compiler and register VM.
 struct TestEnv {
     DefaultInterner interner;
     std::shared_ptr<Scope> globalScope = Scope::createGlobal();
@@ -15,7 +17,11 @@ struct TestEnv {
 
     Value run(const std::string& source) {
         auto ast = std::shared_ptr<AstNode>(Parser::parse(source).release());
+#ifdef FINESCRIPT_TEST_BYTECODE
+        return evaluator.execute(ast, globalScope);
+#else
         return evaluator.eval(ast, globalScope);
+#endif
     }
 };
 
@@ -121,6 +127,25 @@ TEST_CASE("Eval mixed int/float promotes to float", "[evaluator]") {
     CHECK(v.asFloat() == 3.0);
 }
 
+TEST_CASE("Eval float modulo and comparison", "[evaluator]") {
+    TestEnv env;
+    CHECK(env.run("(7.5 % 2.0)").asFloat() == 1.5);
+    CHECK(env.run("(1.5 < 2.5)").asBool() == true);
+    CHECK(env.run("(2.5 >= 2.5)").asBool() == true);
+    CHECK(env.run("(1 < 1.5)").asBool() == true);
+    CHECK(env.run("(2.0 == 2.0)").asBool() == true);
+}
+
+TEST_CASE("Eval operator type error names the operator", "[evaluator]") {
+    TestEnv env;
+    try {
+        env.run("(1 - \"a\")");
+        FAIL("expected ScriptError");
+    } catch (const ScriptError& e) {
+        CHECK(std::string(e.what()).find("'-'") != std::string::npos);
+    }
+}
+
 TEST_CASE("Eval division by zero", "[evaluator]") {
     TestEnv env;
     CHECK_THROWS(env.run("(1 / 0)"));
@@ -231,6 +256,38 @@ TEST_CASE("Eval inclusive range", "[evaluator]") {
     CHECK(v.asArray()[3].asInt() == 3);
 }
 
+TEST_CASE("Eval ranges are lazy until mutated", "[evaluator]") {
+    TestEnv env;
+    env.run("set r (10 .. 20)");
+    CHECK(env.run("r").lazyRange() != nullptr);
+    CHECK(env.run("r.length").asInt() == 10);
+    CHECK(env.run("r[0]").asInt() == 10);
+    CHECK(env.run("r[-1]").asInt() == 19);
+    CHECK(env.run("r.get 3").asInt() == 13);
+    CHECK(env.run("r.contains 15").asBool() == true);
+    CHECK(env.run("r.contains 20").asBool() == false);
+    CHECK(env.run("r.contains \"15\"").asBool() == false);
+    CHECK(env.run("r.slice 2 4") == env.run("[12 13]"));
+    CHECK(env.run("r.slice -3") == env.run("[17 18 19]"));
+    CHECK(env.run("r.map (fn [x] (x * 2))").asArray()[9].asInt() == 38);
+    CHECK(env.run("r.filter (fn [x] (x % 5 == 0))") == env.run("[10 15]"));
+    CHECK(env.run("(r == (10 ..= 19))").asBool() == true);
+    CHECK(env.run("r").lazyRange() != nullptr);
+    CHECK_THROWS_AS(env.run("r[10]"), ScriptError);
+
+    env.run("r.push 99");
+    CHECK(env.run("r").lazyRange() == nullptr);
+    CHECK(env.run("r.length").asInt() == 11);
+    CHECK(env.run("r[-1]").asInt() == 99);
+}
+
+TEST_CASE("Eval for over a large range", "[evaluator]") {
+    TestEnv env;
+    CHECK(env.run("set n 0\nfor i in (0 .. 1000000) do set n (n + 1) end\nn").asInt() == 1000000);
+    CHECK(env.run("set t 0\nfor x in (0 .. 3) do\n  for z in (0 ..= x) do set t (t + z) end\nend\nt").asInt() == 4);
+    CHECK(env.run("set c 0\nfor i in (5 .. 2) do set c 1 end\nc").asInt() == 0);
+}
+
 // === Array indexing ===
 
 TEST_CASE("Eval array indexing", "[evaluator]") {
@@ -314,6 +371,92 @@ end
     CHECK(env.run("counter").asInt() == 3);
 }
 
+TEST_CASE("Eval closure shares captured variables with its frame", "[evaluator]") {
+    TestEnv env;
+    env.run(R"(
+fn outer [] do
+    set n 1
+    fn get [] n
+    set n 5
+    fn bump [] do set n (n + 10) end
+    bump
+    [{get} n]
+end
+)");
+    Value v = env.run("outer");
+    CHECK(v.asArray()[0].asInt() == 15);
+    CHECK(v.asArray()[1].asInt() == 15);
+}
+
+TEST_CASE("Eval nested helpers see siblings defined after them", "[evaluator]") {
+    TestEnv env;
+    env.run(R"(
+fn isOdd [n] "global"
+fn check [k] do
+    fn isEven [n] do
+        if (n == 0) {return true}
+        isOdd (n - 1)
+    end
+    fn isOdd [n] do
+        if (n == 0) {return false}
+        isEven (n - 1)
+    end
+    isEven k
+end
+)");
+    CHECK(env.run("check 6").asBool() == true);
+    CHECK(env.run("check 7").asBool() == false);
+}
+
+TEST_CASE("Eval closures in a loop see names bound after them", "[evaluator]") {
+    TestEnv env;
+    // A helper and a variable the function binds after the loop
+    env.run(R"(
+fn outer [] do
+    set fs []
+    for i in [1 2] do
+        fs.push fn [] ({helper i} + y)
+    end
+    fn helper [x] (x * 100)
+    set y 7
+    set g {fs.get 1}
+    {g}
+end
+)");
+    CHECK(env.run("{outer}").asInt() == 207);
+
+    // A variable the loop body sets after making the closure
+    env.run(R"(
+fn later [] do
+    set f nil
+    for i in [1] do
+        set f fn [] w
+        set w 5
+    end
+    {f}
+end
+)");
+    CHECK(env.run("{later}").asInt() == 5);
+}
+
+TEST_CASE("Eval closure does not keep unused locals alive", "[evaluator]") {
+    TestEnv env;
+    auto big = std::make_shared<MapData>();
+    std::weak_ptr<MapData> watch = big;
+    env.globalScope->define(env.interner.intern("big"), Value::map(std::move(big)));
+    env.run(R"(
+fn make [] do
+    set held big
+    set keep 1
+    fn [] keep
+end
+set f {make}
+set big nil
+)");
+    CHECK(watch.expired());
+    CHECK(env.run("f").asInt() == 1);
+}
+
 // === Return ===
 
 TEST_CASE("Eval return from function", "[evaluator]") {
@@ -338,6 +481,47 @@ end
     CHECK(env.run("nothing").isNil());
 }
 
+TEST_CASE("Eval return unwinds loops and expressions", "[evaluator]") {
+    TestEnv env;
+    env.run(R"(
+set seen []
+fn find [rows target] do
+    for row in rows do
+        for x in row do
+            seen.push x
+            if (x == target) {return [row x]}
+        end
+    end
+    nil
+end
+fn first_big [n] do
+    set i 0
+    while true do
+        set i (i + 1)
+        if ((i * i) > n) do return i end
+    end
+end
+set outer 0
+fn mid_expr [] do
+    set outer (1 + {return 7})
+    99
+end
+)");
+    CHECK(env.run("find [[1 2] [3 4] [5 6]] 4") == env.run("[[3 4] 4]"));
+    CHECK(env.run("seen") == env.run("[1 2 3 4]"));
+    CHECK(env.run("first_big 50").asInt() == 8);
+    CHECK(env.run("mid_expr").asInt() == 7);
+    CHECK(env.run("outer").asInt() == 0);
+    CHECK(env.run("[1 2 3].map (fn [x] do if (x == 2) {return 20}; x end)") == env.run("[1 20 3]"));
+}
+
+TEST_CASE("Eval top-level return ends the program", "[evaluator]") {
+    TestEnv env;
+    CHECK(env.run("set a 1\nreturn (a + 1)\nset a 100").asInt() == 2);
+    CHECK(env.run("a").asInt() == 1);
+    CHECK(env.run("(a + 2)").asInt() == 3);
+}
+
 // === If/elif/else ===
 
 TEST_CASE("Eval if true branch", "[evaluator]") {
@@ -407,6 +591,121 @@ end
     CHECK(env.run("sum").asInt() == 10);
 }
 
+TEST_CASE("Eval for over map walks keys in insertion order", "[evaluator]") {
+    TestEnv env;
+    env.run("set m {=b 2 =a 1 =c 3}");
+    env.run("set order \"\"");
+    env.run("for k in m do\n    set order \"{order}{k}\"\nend");
+    CHECK(env.run("order").asString() == ":b:a:c");
+}
+
+TEST_CASE("Eval for with key and value", "[evaluator]") {
+    TestEnv env;
+    env.run("set m {=x 10 =y 20}");
+    env.run("set total 0");
+    env.run("set names \"\"");
+    env.run(R"(
+for k v in m do
+    set total (total + v)
+    set names "{names}{k}"
+end
+)");
+    CHECK(env.run("total").asInt() == 30);
+    CHECK(env.run("names").asString() == ":x:y");
+
+    env.run("set weighted 0");
+    env.run(R"(
+for i v in [5 6 7] do
+    set weighted (weighted + i * v)
+end
+)");
+    CHECK(env.run("weighted").asInt() == 20);
+}
+
+TEST_CASE("Eval for over string", "[evaluator]") {
+    TestEnv env;
+    env.run("set out \"\"");
+    env.run("for c in \"abc\" do\n    set out \"{c}{out}\"\nend");
+    CHECK(env.run("out").asString() == "cba");
+}
+
+TEST_CASE("Eval for over map survives removing each key", "[evaluator]") {
+    TestEnv env;
+    env.run("set m {=a 1 =b 2 =c 3 =d 4 =e 5 =f 6}");
+    env.run("m.remove :a");
+    env.run("set order \"\"");
+    env.run("for k in m do\n    m.remove k\n    set order \"{order}{k}\"\nend");
+    CHECK(env.run("order").asString() == ":b:c:d:e:f");
+    CHECK(env.run("m.keys").asArray().empty());
+}
+
+TEST_CASE("Eval for over string steps by UTF-8 character", "[evaluator]") {
+    TestEnv env;
+    env.run("set out []");
+    env.run("for c in \"a\u00e9\u20ac\U0001F600b\" do\n    out.push c\nend");
+    auto out = env.run("out");
+    REQUIRE(out.asArray().size() == 5);
+    CHECK(out.asArray()[1].asString() == "\u00e9");
+    CHECK(out.asArray()[2].asString() == "\u20ac");
+    CHECK(out.asArray()[3].asString() == "\U0001F600");
+    CHECK(out.asArray()[4].asString() == "b");
+
+    // The index is the character's byte offset; stray bytes step singly
+    env.run("set offsets []");
+    env.run("for i c in \"\u00e9x\xff\" do\n    offsets.push i\nend");
+    auto offsets = env.run("offsets");
+    REQUIRE(offsets.asArray().size() == 3);
+    CHECK(offsets.asArray()[1].asInt() == 2);
+    CHECK(offsets.asArray()[2].asInt() == 3);
+}
+
+TEST_CASE("Eval for over large map", "[evaluator]") {
+    TestEnv env;
+    auto m = Value::map();
+    for (uint32_t i = 0; i < 10000; i++) m.asMap().set(i, Value::integer(i));
+    env.globalScope->define(env.interner.intern("m"), m);
+    env.run("set sum 0");
+    env.run("for k v in m do\n    set sum (sum + v)\nend");
+    CHECK(env.run("sum").asInt() == 49995000);
+}
+
+namespace {
+class ListProxy : public ProxyMap {
+public:
+    std::vector<std::pair<uint32_t, int64_t>> items;
+    Value get(uint32_t key) const override {
+        for (auto& [k, v] : items) if (k == key) return Value::integer(v);
+        return Value::nil();
+    }
+    void set(uint32_t key, Value value) override { items.push_back({key, value.asInt()}); }
+    bool has(uint32_t key) const override { return !get(key).isNil(); }
+    bool remove(uint32_t) override { return false; }
+    std::vector<uint32_t> keys() const override {
+        std::vector<uint32_t> result;
+        for (auto& [k, v] : items) result.push_back(k);
+        return result;
+    }
+};
+} // anonymous namespace
+
+TEST_CASE("Eval for over proxy map", "[evaluator]") {
+    TestEnv env;
+    auto proxy = std::make_shared<ListProxy>();
+    proxy->items = {{env.interner.intern("hp"), 7}, {env.interner.intern("mp"), 3}};
+    env.globalScope->define(env.interner.intern("stats"), Value::proxyMap(proxy));
+    env.run("set total 0");
+    env.run("set count 0");
+    env.run("for k v in stats do\n    set total (total + v)\nend");
+    env.run("for k in stats do\n    set count (count + 1)\nend");
+    CHECK(env.run("total").asInt() == 10);
+    CHECK(env.run("count").asInt() == 2);
+}
+
+TEST_CASE("Eval for over non-iterable throws", "[evaluator]") {
+    TestEnv env;
+    CHECK_THROWS_AS(env.run("for x in 42 do\n    x\nend"), ScriptError);
+}
+
 TEST_CASE("Eval for loop variable is scoped", "[evaluator]") {
     TestEnv env;
     env.run(R"(
@@ -584,6 +883,21 @@ TEST_CASE("Eval map keys and values", "[evaluator]") {
     CHECK(vals.asArray().size() == 2);
 }
 
+TEST_CASE("Eval map keys follow insertion order", "[evaluator]") {
+    TestEnv env;
+    env.run("set m {=zeta 1 =alpha 2 =mid 3}");
+    env.run("m.set :first 4");
+    env.run("m.remove :alpha");
+    Value keys = env.run("m.keys");
+    REQUIRE(keys.asArray().size() == 3);
+    CHECK(keys.asArray()[0].asSymbol() == env.interner.intern("zeta"));
+    CHECK(keys.asArray()[1].asSymbol() == env.interner.intern("mid"));
+    CHECK(keys.asArray()[2].asSymbol() == env.interner.intern("first"));
+    Value vals = env.run("m.values");
+    CHECK(vals.asArray()[0].asInt() == 1);
+    CHECK(vals.asArray()[2].asInt() == 4);
+}
+
 // === Method calls (setMethod + auto-self) ===
 
 TEST_CASE("Eval setMethod and method call with self", "[evaluator]") {
@@ -602,8 +916,70 @@ TEST_CASE("Eval setMethod and method call with self", "[evaluator]") {
     CHECK(env.run("obj.getName").asString() == "Alice");
 }
 
+TEST_CASE("Eval method call with more arguments than fit inline", "[evaluator]") {
+    TestEnv env;
+    env.run("set obj {=base 100}");
+    env.run("obj.setMethod :total fn [self a b c d e f g] (self.base + a + b + c + d + e + f + g)");
+    CHECK(env.run("obj.total 1 2 3 4 5 6 7").asInt() == 128);
+    env.run("fn sum8 [a b c d e f g h] (a + b + c + d + e + f + g + h)");
+    CHECK(env.run("sum8 1 2 3 4 5 6 7 8").asInt() == 36);
+}
+
+TEST_CASE("Eval methods added to built-in types", "[evaluator]") {
+    TestEnv env;
+    env.evaluator.setMethod(Value::Type::Array, env.interner.intern("sum"),
+        [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) {
+            int64_t total = 0;
+            for (const auto& v : self.asArray()) total += v.asInt();
+            return Value::integer(total);
+        });
+    CHECK(env.run("set xs [1 2 3 4]\n{xs.sum}").asInt() == 10);
+    CHECK(env.run("{(1 ..= 5).sum}").asInt() == 15);
+    CHECK(env.run("xs.push 5\n{xs.sum}").asInt() == 15);  // built-ins unaffected
+
+    // A callable value gets the receiver first; IDs past the dense range work too
+    for (int i = 0; i < 1100; i++) env.interner.intern("padding_" + std::to_string(i));
+    uint32_t wrap = env.interner.intern("wrap");
+    REQUIRE(wrap >= MethodTable::kDenseLimit);
+    env.evaluator.setMethod(Value::Type::String, wrap,
+                            env.run("fn [s left right] \"{left}{s}{right}\""));
+    CHECK(env.run("\"ab\".wrap \"<\" \">\"").asString() == "<ab>");
+    CHECK_THROWS_AS(env.run("[1].wrap 3"), ScriptError);
+
+    // Like the built-in map methods, a type method wins over a field
+    env.evaluator.setMethod(Value::Type::Map, env.interner.intern("size"),
+        [](Evaluator&, const Value& self, ArgSpan, ExecutionContext*, SourceLocation) {
+            return Value::integer(static_cast<int64_t>(self.asMap().size()));
+        });
+    CHECK(env.run("set m {=a 1 =size 99}\n{m.size}").asInt() == 2);
+}
+
 // === Auto-method detection (first param named "self") ===
 
+TEST_CASE("Eval field access sites follow map changes", "[evaluator]") {
+    TestEnv env;
+    env.run(R"(
+set a {=v 1 =n 5}
+set b {=v 2}
+fn getv [o] o.v
+fn call [o] {o.read}
+)");
+    // One site, alternating receivers
+    CHECK(env.run("({getv a} + {getv b} + {getv a})").asInt() == 4);
+    env.run("set a.v 10");
+    CHECK(env.run("getv a").asInt() == 10);
+    env.run("a.remove :v");
+    CHECK(env.run("getv a").isNil());
+    env.run("a.set :v 3");
+    CHECK(env.run("getv a").asInt() == 3);
+
+    // A plain function field, then a method under the same key
+    env.run("set a.read fn [] 1");
+    CHECK(env.run("call a").asInt() == 1);
+    env.run("set a.read fn [self] self.n");
+    CHECK(env.run("call a").asInt() == 5);
+}
+
 TEST_CASE("Auto-method detection in map literal", "[evaluator]") {
     TestEnv env;
     // Closure with first param "self" should be auto-detected as method
@@ -1152,6 +1528,61 @@ TEST_CASE("String mutation is visible through aliases", "[evaluator][string]") {
     CHECK(env.run("t").asString() == "hello!");
 }
 
+TEST_CASE("String literals are not changed by mutating their values", "[evaluator][string]") {
+    TestEnv env;
+    env.run("fn label [] \"ready\"");
+    env.run("set s {label}");
+    env.run("{s.push \"!\"}");
+    CHECK(env.run("{label}").asString() == "ready");
+
+    // Literals in operator and interpolation positions are shared, but a
+    // value that escapes through ?? is still the caller's own
+    env.run("fn pick [x] (x ?? \"none\")");
+    env.run("set t {pick nil}");
+    env.run("{t.push \"?\"}");
+    CHECK(env.run("t").asString() == "none?");
+    CHECK(env.run("{pick nil}").asString() == "none");
+    CHECK(env.run("(\"a\" + \"b\")").asString() == "ab");
+    CHECK(env.run("\"{t}-\"").asString() == "none?-");
+    CHECK(env.run("match \"x\"\n    \"x\" 1\n    _ 2\nend").asInt() == 1);
+}
+
+TEST_CASE("String building by self-concatenation", "[evaluator][string]") {
+    TestEnv env;
+    env.run("set s \"\"");
+    env.run("for i in (0 .. 1000) do\n    set s (s + \"ab\")\nend");
+    CHECK(env.run("s.length").asInt() == 2000);
+    env.run("for i in (0 .. 100) do\n    set s \"{s}{i},\"\nend");
+    CHECK(env.run("s.length").asInt() == 2290);
+
+    // Nothing else holds the string, so it grows in place (a new string
+    // would be built while the old one is still alive, at another address)
+    auto storage = [&] { return &env.globalScope->lookup(env.interner.intern("s"))->asString(); };
+    const std::string* before = storage();
+    env.run("set s (s + \"cd\")");
+    CHECK(storage() == before);
+    env.run("set s \"{s}ef\"");
+    CHECK(storage() == before);
+    CHECK(env.run("s.length").asInt() == 2294);
+
+    // An alias keeps its value: the variable gets a new string
+    env.run("set t \"x\"");
+    env.run("set u t");
+    env.run("set t (t + \"y\")");
+    env.run("set u \"{u}\"");
+    env.run("set t \"{t}z\"");
+    CHECK(env.run("t").asString() == "xyz");
+    CHECK(env.run("u").asString() == "x");
+
+    // Non-string operands keep their usual meaning
+    env.run("set n 1");
+    env.run("set n (n + 2)");
+    CHECK(env.run("n").asInt() == 3);
+    env.run("set n \"{n}!\"");
+    CHECK(env.run("n").asString() == "3!");
+    CHECK_THROWS_AS(env.run("set n (n + 1)"), ScriptError);
+}
+
 TEST_CASE("String methods chained operations", "[evaluator][string]") {
     TestEnv env;
     // Build a string through mutations
@@ -1263,6 +1694,17 @@ TEST_CASE("Default params evaluated at call time", "[evaluator][defaults]") {
     CHECK(env.run("{next_id 99}").asInt() == 99);
 }
 
+TEST_CASE("Default params: return in a default completes the call", "[evaluator][defaults]") {
+    TestEnv env;
+    env.run("fn f [=x do return 11 end] (x + 1)");
+    CHECK(env.run("{f}").asInt() == 11);
+    CHECK(env.run("{f 4}").asInt() == 5);
+    env.run("fn g [] do\n  set y {f}\n  (y + 100)\nend");
+    CHECK(env.run("{g}").asInt() == 111);
+    // Nothing is left unwinding for the next run
+    CHECK(env.run("set n 0\nfor i in [1 2 3] do\n  set n (n + i)\nend\nn").asInt() == 6);
+}
+
 // === Variadic Arguments ===
 
 TEST_CASE("Rest param only", "[evaluator][variadic]") {
@@ -1,12 +1,15 @@
 #include <catch2/catch_test_macros.hpp>
 #include "finescript/script_engine.h"
+#include "finescript/ast.h"
 #include "finescript/execution_context.h"
 #include "finescript/interner.h"
+#include "finescript/builtin_symbols.h"
 #include "finescript/error.h"
 #include "finescript/map_data.h"
 #include "finescript/resource_finder.h"
 #include <fstream>
 #include <filesystem>
+#include <thread>
 
 using namespace finescript;
 
@@ -51,7 +54,7 @@ TEST_CASE("Integration: function definition and call", "[integration]") {
 TEST_CASE("Integration: register and call native function", "[integration]") {
     ScriptEngine engine;
     engine.registerFunction("add_native",
-        [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+        [](ExecutionContext&, ArgSpan args) -> Value {
             if (args.size() < 2) return Value::nil();
             return Value::integer(args[0].asInt() + args[1].asInt());
         });
@@ -62,10 +65,41 @@ TEST_CASE("Integration: register and call native function", "[integration]") {
     CHECK(result.returnValue.asInt() == 30);
 }
 
+TEST_CASE("Integration: calls with more arguments than fit inline", "[integration]") {
+    ScriptEngine engine;
+    engine.registerFunction("sum_native",
+        [](ExecutionContext&, ArgSpan args) -> Value {
+            int64_t total = 0;
+            for (const auto& a : args) total += a.asInt();
+            return Value::integer(total);
+        });
+
+    ExecutionContext ctx(engine);
+    auto result = run(engine, ctx, "sum_native 1 2 3 4 5 6 7 8");
+    CHECK(result.success);
+    CHECK(result.returnValue.asInt() == 36);
+
+    // Method call: self plus seven arguments spills the argument buffer
+    result = run(engine, ctx, R"(
+set obj {=base 100}
+obj.setMethod :total fn [self a b c d e f g] (self.base + a + b + c + d + e + f + g)
+obj.total 1 2 3 4 5 6 7
+)");
+    CHECK(result.success);
+    CHECK(result.returnValue.asInt() == 128);
+
+    auto fn = run(engine, ctx, "~sum_native");
+    REQUIRE(fn.success);
+    Value args[] = {Value::integer(1), Value::integer(2), Value::integer(3), Value::integer(4),
+                    Value::integer(5), Value::integer(6), Value::integer(7)};
+    auto direct = engine.callFunction(fn.returnValue, ArgSpan(args, 7), ctx);
+    CHECK(direct.asInt() == 28);
+}
+
 TEST_CASE("Integration: native function with context access", "[integration]") {
     ScriptEngine engine;
     engine.registerFunction("get_player_name",
-        [](ExecutionContext& ctx, const std::vector<Value>&) -> Value {
+        [](ExecutionContext& ctx, ArgSpan) -> Value {
             return ctx.get("player_name");
         });
 
@@ -76,6 +110,55 @@ TEST_CASE("Integration: native function with context access", "[integration]") {
     CHECK(result.returnValue.asString() == "Alice");
 }
 
+// === Method registration ===
+
+TEST_CASE("Integration: register methods on built-in types", "[integration]") {
+    ScriptEngine engine;
+    engine.registerMethod(Value::Type::Array, "sum", [](ExecutionContext&, ArgSpan args) -> Value {
+        double total = 0;
+        for (const auto& v : args[0].asArray()) total += v.asNumber();
+        return Value::number(total);
+    });
+    engine.registerMethod(Value::Type::Array, "dot", [](ExecutionContext&, ArgSpan args) -> Value {
+        auto& a = args[0].asArray();
+        auto& b = args[1].asArray();
+        double total = 0;
+        for (size_t i = 0; i < a.size() && i < b.size(); i++) total += a[i].asNumber() * b[i].asNumber();
+        return Value::number(total);
+    });
+    engine.registerMethod(Value::Type::String, "shout", [](ExecutionContext& ctx, ArgSpan args) -> Value {
+        return Value::string(args[0].asString() + ctx.get("mark").asString());
+    });
+
+    ExecutionContext ctx(engine);
+    ctx.set("mark", Value::string("!"));
+    auto result = run(engine, ctx, R"(
+set v [1 2 3]
+[{v.sum} {v.dot [4 5 6]} {"hey".shout} {(1 ..= 4).sum}]
+)");
+    REQUIRE(result.success);
+    auto& arr = result.returnValue.asArray();
+    CHECK(arr[0].asNumber() == 6);
+    CHECK(arr[1].asNumber() == 32);
+    CHECK(arr[2].asString() == "hey!");
+    CHECK(arr[3].asNumber() == 10);
+
+    // Only values of the registered type have the method
+    CHECK_FALSE(run(engine, ctx, "\"abc\".sum").success);
+
+    // Registered before or after the evaluator exists, and kept across an interner change
+    engine.registerMethod(Value::Type::Map, "size", [](ExecutionContext&, ArgSpan args) -> Value {
+        return Value::integer(static_cast<int64_t>(args[0].asMap().size()));
+    });
+    DefaultInterner other;
+    other.intern("padding");
+    engine.setInterner(&other);
+    result = run(engine, ctx, "set m {=a 1 =b 2}\n[{m.size} {[1 2].sum}]");
+    REQUIRE(result.success);
+    CHECK(result.returnValue.asArray()[0].asInt() == 2);
+    CHECK(result.returnValue.asArray()[1].asNumber() == 3);
+}
+
 // === Constant registration ===
 
 TEST_CASE("Integration: register constant", "[integration]") {
@@ -338,6 +421,14 @@ TEST_CASE("Integration: intern and lookupSymbol", "[integration]") {
     CHECK(id == id2);
 }
 
+TEST_CASE("Integration: builtin symbols have fixed IDs", "[integration]") {
+    ScriptEngine engine;
+    CHECK(engine.intern("get") == static_cast<uint32_t>(BuiltinSymbol::Get));
+    CHECK(engine.intern("starts_with") == static_cast<uint32_t>(BuiltinSymbol::StartsWith));
+    CHECK(engine.lookupSymbol(static_cast<uint32_t>(BuiltinSymbol::Self)) == "self");
+    CHECK(engine.intern("not_builtin") >= kFirstHostSymbol);
+}
+
 TEST_CASE("Integration: custom interner", "[integration]") {
     ScriptEngine engine;
     DefaultInterner customInterner;
@@ -348,6 +439,24 @@ TEST_CASE("Integration: custom interner", "[integration]") {
     CHECK(customInterner.lookup(id) == "custom_test");
 }
 
+TEST_CASE("Integration: scripts rebind symbols after interner change", "[integration]") {
+    ScriptEngine engine;
+    auto script = engine.parseString("set m {=alpha 1 =beta 2}\n[m.beta :gamma]");
+    CHECK(script->root->boundInterner == &engine.interner());
+
+    // Shift IDs so stale bindings would resolve to the wrong names
+    DefaultInterner customInterner;
+    customInterner.intern("padding");
+    engine.setInterner(&customInterner);
+    ExecutionContext ctx(engine);
+    auto result = engine.execute(*script, ctx);
+    REQUIRE(result.success);
+    CHECK(script->root->boundInterner == &customInterner);
+    auto& arr = result.returnValue.asArray();
+    CHECK(arr[0].asInt() == 2);
+    CHECK(customInterner.lookup(arr[1].asSymbol()) == "gamma");
+}
+
 // === Complex end-to-end ===
 
 TEST_CASE("Integration: complex script with all features", "[integration]") {
@@ -463,7 +572,7 @@ TEST_CASE("Integration: callFunction with script closure", "[integration]") {
 TEST_CASE("Integration: callFunction with native function", "[integration]") {
     ScriptEngine engine;
     engine.registerFunction("add_native",
-        [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+        [](ExecutionContext&, ArgSpan args) -> Value {
             return Value::integer(args[0].asInt() + args[1].asInt());
         });
 
@@ -509,6 +618,61 @@ set counter {makeCounter}
     CHECK(v3.asInt() == 3);
 }
 
+namespace {
+struct CountingInterner : DefaultInterner {
+    int calls = 0;
+    uint32_t intern(std::string_view str) override {
+        calls++;
+        return DefaultInterner::intern(str);
+    }
+};
+} // anonymous namespace
+
+TEST_CASE("Integration: engine reuses its evaluator across calls", "[integration]") {
+    ScriptEngine engine;
+    CountingInterner counting;
+    counting.intern("padding");  // shift IDs away from the engine's own interner
+    engine.setInterner(&counting);
+    ExecutionContext ctx(engine);
+
+    auto r = run(engine, ctx, "fn [xs] do\n  xs.push 4\n  xs.length\nend");
+    REQUIRE(r.success);
+    int before = counting.calls;
+    for (int i = 0; i < 10; i++) {
+        Value arr = Value::array({Value::integer(1), Value::integer(2), Value::integer(3)});
+        CHECK(engine.callFunction(r.returnValue, {arr}, ctx).asInt() == 4);
+    }
+    CHECK(counting.calls == before);
+
+    // A new interner gets a fresh evaluator whose method symbols match it
+    DefaultInterner other;
+    other.intern("more padding");
+    other.intern("and more");
+    engine.setInterner(&other);
+    auto r2 = run(engine, ctx, "set a [1]\na.push 2\na.length");
+    REQUIRE(r2.success);
+    CHECK(r2.returnValue.asInt() == 2);
+}
+
+TEST_CASE("Integration: native functions can call back into the engine", "[integration]") {
+    ScriptEngine engine;
+    ExecutionContext ctx(engine);
+    engine.registerFunction("twice", [&engine](ExecutionContext& c, ArgSpan args) {
+        Value once = engine.callFunction(args[0], {args[1]}, c);
+        return engine.callFunction(args[0], {once}, c);
+    });
+
+    auto r = run(engine, ctx, "fn inc [x] (x + 1)\n({twice inc 5} + {twice inc 0})");
+    REQUIRE(r.success);
+    CHECK(r.returnValue.asInt() == 9);
+
+    auto err = run(engine, ctx, "twice (fn [x] (x + nil)) 1");
+    CHECK_FALSE(err.success);
+    auto ok = run(engine, ctx, "twice inc 40");
+    REQUIRE(ok.success);
+    CHECK(ok.returnValue.asInt() == 42);
+}
+
 TEST_CASE("Integration: callFunction non-callable throws", "[integration]") {
     ScriptEngine engine;
     ExecutionContext ctx(engine);
@@ -519,6 +683,29 @@ TEST_CASE("Integration: callFunction non-callable throws", "[integration]") {
     );
 }
 
+#if !FINESCRIPT_ATOMIC_REFCOUNT
+TEST_CASE("Integration: engine checks its owning thread", "[integration][thread]") {
+    ScriptEngine engine;
+    ExecutionContext ctx(engine);
+
+    bool rejected = false;
+    FullScriptResult result;
+    std::thread other([&] {
+        try {
+            run(engine, ctx, "(1 + 2)");
+        } catch (const std::logic_error&) {
+            rejected = true;
+        }
+        engine.bindToCurrentThread();
+        result = run(engine, ctx, "(1 + 2)");
+    });
+    other.join();
+    CHECK(rejected);
+    CHECK(result.returnValue.asInt() == 3);
+    CHECK_THROWS_AS(run(engine, ctx, "(1 + 2)"), std::logic_error);
+}
+#endif
+
 TEST_CASE("Integration: callFunction with method closure", "[integration]") {
     ScriptEngine engine;
     ExecutionContext ctx(engine);
@@ -622,7 +809,7 @@ TEST_CASE("Integration: native function receives kwargs map as last arg", "[inte
     ScriptEngine engine;
     // Native function that returns its last arg (should be kwargs map)
     engine.registerFunction("get_kwargs",
-        [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+        [](ExecutionContext&, ArgSpan args) -> Value {
             if (args.empty()) return Value::nil();
             return args.back();
         });
@@ -642,7 +829,7 @@ TEST_CASE("Integration: native function kwargs with positional args", "[integrat
     ScriptEngine engine;
     // Native function: args[0] is positional, args[1] is kwargs map
     engine.registerFunction("mixed_args",
-        [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+        [](ExecutionContext&, ArgSpan args) -> Value {
             // Return array of [positional, kwargs_map]
             std::vector<Value> result;
             for (auto& a : args) result.push_back(a);
@@ -664,7 +851,7 @@ TEST_CASE("Integration: native function kwargs with positional args", "[integrat
 TEST_CASE("Integration: native function with no named args gets no kwargs map", "[integration][native-kwargs]") {
     ScriptEngine engine;
     engine.registerFunction("count_args",
-        [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+        [](ExecutionContext&, ArgSpan args) -> Value {
             return Value::integer(static_cast<int64_t>(args.size()));
         });
 
@@ -680,7 +867,7 @@ TEST_CASE("Integration: native function in map receives kwargs via method call",
 
     // Register a native function, store in a map, call via dot notation
     engine.registerFunction("make_kwargs_receiver",
-        [](ExecutionContext&, const std::vector<Value>& args) -> Value {
+        [](ExecutionContext&, ArgSpan args) -> Value {
             if (args.empty()) return Value::nil();
             return args.back();  // Return last arg (kwargs map)
         });
@@ -1,5 +1,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include "finescript/interner.h"
+#include "finescript/builtin_symbols.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
 
 using namespace finescript;
 
@@ -69,3 +73,88 @@ TEST_CASE("DefaultInterner invalid lookup throws", "[interner]") {
     DefaultInterner interner;
     CHECK_THROWS(interner.lookup(999));
 }
+
+TEST_CASE("DefaultInterner precomputed hash gives the same IDs", "[interner]") {
+    DefaultInterner interner;
+
+    uint32_t plain = interner.intern("stone_bricks");
+    CHECK(interner.intern("stone_bricks", symbolHash("stone_bricks")) == plain);
+
+    uint32_t hashed = interner.intern("oak_log", symbolHash("oak_log"));
+    CHECK(interner.intern("oak_log") == hashed);
+    CHECK(interner.lookup(hashed) == "oak_log");
+    CHECK(interner.size() == 2);
+}
+
+namespace {
+constexpr std::string_view kBlockNames[] = {"air", "stone", "dirt"};
+enum BlockSymbol : uint32_t { Air = kFirstHostSymbol, Stone, Dirt };
+} // anonymous namespace
+
+TEST_CASE("DefaultInterner reserves static symbol tables", "[interner]") {
+    DefaultInterner interner({builtinSymbols(), StaticSymbols(kBlockNames)});
+
+    CHECK(interner.size() == kBuiltinSymbolCount + 3);
+    CHECK(interner.intern("push") == static_cast<uint32_t>(BuiltinSymbol::Push));
+    CHECK(interner.lookup(static_cast<uint32_t>(BuiltinSymbol::Self)) == "self");
+    CHECK(interner.intern("stone") == Stone);
+    CHECK(interner.lookup(Dirt) == "dirt");
+    CHECK(interner.intern("grass") == kFirstHostSymbol + 3);
+
+    // A repeated spelling would shift every later ID
+    constexpr std::string_view repeated[] = {"a", "b", "a"};
+    CHECK_THROWS_AS(DefaultInterner({StaticSymbols(repeated)}), std::invalid_argument);
+}
+
+TEST_CASE("DefaultInterner keeps text across chunks", "[interner]") {
+    DefaultInterner interner;
+
+    // Enough text to fill several chunks, plus strings too long to share one
+    std::vector<std::string> strings;
+    for (int i = 0; i < 20000; i++) strings.push_back("mod_" + std::to_string(i) + ":block");
+    strings.push_back(std::string(40000, 'x'));
+    strings.push_back(std::string(100000, 'y'));
+    strings.push_back("after_long");
+
+    std::vector<uint32_t> ids;
+    for (auto& s : strings) ids.push_back(interner.intern(s));
+    for (size_t i = 0; i < strings.size(); i++) {
+        CHECK(interner.lookup(ids[i]) == strings[i]);
+        CHECK(interner.intern(strings[i]) == ids[i]);
+    }
+}
+
+TEST_CASE("DefaultInterner is safe to share between threads", "[interner][thread]") {
+    DefaultInterner interner;
+    for (int i = 0; i < 100; i++) interner.intern("pre_" + std::to_string(i));
+
+    // Every thread interns the same names in a different order, mixing hits
+    // on existing names with races to insert new ones, and reads back others
+    constexpr int kThreads = 8;
+    constexpr int kNames = 4000;
+    std::vector<std::vector<uint32_t>> ids(kThreads, std::vector<uint32_t>(kNames));
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t] {
+            for (int n = 0; n < kNames; n++) {
+                int i = (n * 7 + t * 977) % kNames;
+                std::string name = "name_" + std::to_string(i);
+                uint32_t id = interner.intern(name);
+                ids[t][i] = id;
+                if (interner.lookup(id) != name) failed = true;
+                if (interner.intern("pre_" + std::to_string(n % 100)) != static_cast<uint32_t>(n % 100)) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    CHECK_FALSE(failed);
+    CHECK(interner.size() == 100 + kNames);
+    for (int t = 1; t < kThreads; t++) CHECK(ids[t] == ids[0]);
+    for (int i = 0; i < kNames; i++) {
+        CHECK(interner.lookup(ids[0][i]) == "name_" + std::to_string(i));
+    }
+}
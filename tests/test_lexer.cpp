@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 #include "finescript/lexer.h"
+#include "finescript/interner.h"
 
 using namespace finescript;
 
@@ -452,3 +453,14 @@ TEST_CASE("Lexer ?: followed by :symbol", "[lexer]") {
     CHECK(tokens[3].text == "default");
     CHECK(tokens[4].type == TokenType::RightParen);
 }
+
+TEST_CASE("Lexer hashes names while scanning", "[lexer]") {
+    auto tokens = tokenize("set block_id :stone {f =count 3}");
+    REQUIRE(tokens.size() == 9);
+    CHECK(tokens[1].type == TokenType::Name);
+    CHECK(tokens[1].hash == symbolHash("block_id"));
+    CHECK(tokens[2].type == TokenType::SymbolLiteral);
+    CHECK(tokens[2].hash == symbolHash("stone"));
+    CHECK(tokens[5].type == TokenType::KeyName);
+    CHECK(tokens[5].hash == symbolHash("count"));
+}
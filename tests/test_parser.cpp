@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include "finescript/parser.h"
 #include "finescript/ast.h"
+#include "finescript/interner.h"
 
 using namespace finescript;
 
@@ -159,6 +160,15 @@ TEST_CASE("Parser simple infix", "[parser]") {
     CHECK(ast->children[1]->kind == AstNodeKind::IntLit);
 }
 
+TEST_CASE("Parser infix resolves operator enum", "[parser]") {
+    CHECK(parseExpr("(x + 5)")->binOp == BinaryOp::Add);
+    CHECK(parseExpr("(x <= 5)")->binOp == BinaryOp::Le);
+    CHECK(parseExpr("(0 ..= 5)")->binOp == BinaryOp::RangeIncl);
+    CHECK(parseExpr("(a and b)")->binOp == BinaryOp::And);
+    CHECK(parseExpr("(a ?? b)")->binOp == BinaryOp::NilCoalesce);
+    CHECK(std::string(binaryOpName(BinaryOp::FalsyCoalesce)) == "?:");
+}
+
 TEST_CASE("Parser infix precedence mul over add", "[parser]") {
     auto ast = parseExpr("(a + b * c)");
     // Should be: a + (b * c)
@@ -439,6 +449,16 @@ TEST_CASE("Parser for over expression", "[parser]") {
     CHECK(node->children[0]->kind == AstNodeKind::Call);
 }
 
+TEST_CASE("Parser for with key and value", "[parser]") {
+    auto ast = parse("for k v in m do\n  print k v\nend");
+    auto& node = ast->children[0];
+    CHECK(node->kind == AstNodeKind::For);
+    REQUIRE(node->nameParts.size() == 2);
+    CHECK(node->nameParts[0] == "k");
+    CHECK(node->nameParts[1] == "v");
+    CHECK(node->children[0]->kind == AstNodeKind::Name);
+}
+
 // ---- While ----
 
 TEST_CASE("Parser while loop", "[parser]") {
@@ -731,3 +751,38 @@ TEST_CASE("Parser source locations preserved", "[parser]") {
     CHECK(node->loc.line == 1);
     CHECK(node->loc.column == 1);
 }
+
+// ---- Symbol binding ----
+
+TEST_CASE("bindSymbols interns identifiers into the AST", "[parser]") {
+    DefaultInterner interner;
+    auto ast = parse("fn f [a [rest] {opts}] (a.b + :sym)\nset m {=k 1}");
+    bindSymbols(*ast, interner);
+    CHECK(ast->boundInterner == &interner);
+
+    auto& fn = *ast->children[0];
+    CHECK(fn.symbolId == interner.intern("f"));
+    CHECK(fn.nameIds == std::vector<uint32_t>{interner.intern("a")});
+    CHECK(fn.restId == interner.intern("rest"));
+    CHECK(fn.kwargsId == interner.intern("opts"));
+
+    auto& body = *fn.children[0];
+    auto& dotted = *body.children[0];
+    CHECK(dotted.nameIds == std::vector<uint32_t>{interner.intern("b")});
+    CHECK(dotted.children[0]->symbolId == interner.intern("a"));
+    CHECK(body.children[1]->symbolId == interner.intern("sym"));
+
+    auto& set = *ast->children[1];
+    CHECK(set.nameIds == std::vector<uint32_t>{interner.intern("m")});
+    CHECK(set.children[0]->nameIds == std::vector<uint32_t>{interner.intern("k")});
+}
+
+TEST_CASE("bindSymbols leaves unnamed fields unset", "[parser]") {
+    DefaultInterner interner;
+    auto ast = parse("fn [x] x");
+    bindSymbols(*ast, interner);
+    auto& fn = *ast->children[0];
+    CHECK(fn.symbolId == kNoSymbol);
+    CHECK(fn.restId == kNoSymbol);
+    CHECK(fn.kwargsId == kNoSymbol);
+}
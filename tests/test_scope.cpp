@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include "finescript/scope.h"
 #include "finescript/interner.h"
+#include <thread>
 
 using namespace finescript;
 
@@ -181,3 +182,106 @@ TEST_CASE("Scope multiple bindings", "[scope]") {
     CHECK(scope->lookup(b)->asString() == "two");
     CHECK(scope->lookup(c)->asBool() == true);
 }
+
+TEST_CASE("Scope grows past its inline bindings", "[scope]") {
+    auto global = Scope::createGlobal();
+    auto scope = global->createChild();
+    global->define(1000, Value::integer(-1));
+
+    Value* first = nullptr;
+    for (uint32_t sym = 0; sym < 40; sym++) {
+        scope->define(sym, Value::integer(sym));
+        if (sym == 0) first = scope->lookup(0);
+    }
+    CHECK(scope->lookup(0) == first);  // bindings never move
+    for (uint32_t sym = 0; sym < 40; sym++) {
+        REQUIRE(scope->hasLocal(sym));
+        CHECK(scope->lookup(sym)->asInt() == sym);
+    }
+    CHECK(scope->localKeys().size() == 40);
+
+    scope->set(2, Value::integer(200));
+    scope->set(30, Value::integer(300));
+    scope->set(1000, Value::integer(1));
+    CHECK(scope->lookup(2)->asInt() == 200);
+    CHECK(scope->lookup(30)->asInt() == 300);
+    CHECK_FALSE(scope->hasLocal(1000));
+    CHECK(global->lookup(1000)->asInt() == 1);
+}
+
+TEST_CASE("Scope layout slots start unbound", "[scope]") {
+    DefaultInterner interner;
+    auto layout = std::make_shared<ScopeLayout>();
+    layout->names = {interner.intern("a"), interner.intern("b")};
+    auto global = Scope::createGlobal();
+    global->define(interner.intern("a"), Value::integer(1));
+    auto child = global->createChild(layout);
+
+    // Unbound slot: lookup falls through to the parent
+    CHECK(child->slot(0) == nullptr);
+    CHECK(child->lookup(interner.intern("a"))->asInt() == 1);
+    CHECK_FALSE(child->hasLocal(interner.intern("a")));
+
+    child->bindSlot(0, Value::integer(2));
+    CHECK(child->lookup(interner.intern("a"))->asInt() == 2);
+    CHECK(child->localKeys() == std::vector<uint32_t>{interner.intern("a")});
+}
+
+TEST_CASE("Scope define by name binds layout slots", "[scope]") {
+    DefaultInterner interner;
+    auto layout = std::make_shared<ScopeLayout>();
+    layout->names = {interner.intern("x")};
+    auto scope = Scope::createGlobal()->createChild(layout);
+
+    scope->set(interner.intern("x"), Value::integer(5));
+    REQUIRE(scope->slot(0) != nullptr);
+    CHECK(scope->slot(0)->asInt() == 5);
+    CHECK_FALSE(scope->hasDynamicBindings());
+
+    scope->define(interner.intern("y"), Value::integer(6));
+    CHECK(scope->hasDynamicBindings());
+}
+
+TEST_CASE("Scope frames outlive the scope tree that created them", "[scope]") {
+    auto layout = std::make_shared<ScopeLayout>();
+    layout->names = {7, 8};
+
+    std::shared_ptr<Scope> captured;
+    {
+        auto global = Scope::createGlobal();
+        global->define(1, Value::string("kept"));
+        // Churn frames so later ones reuse recycled blocks
+        for (int i = 0; i < 100; i++) {
+            auto frame = global->createChild(layout);
+            frame->bindSlot(0, Value::integer(i));
+        }
+        captured = global->createChild(layout);
+        captured->define(8, Value::integer(42));
+    }
+    CHECK_FALSE(captured->hasLocal(7));
+    CHECK(captured->lookup(8)->asInt() == 42);
+    CHECK(captured->lookup(1)->asString() == "kept");
+    auto child = captured->createChild();
+    child->set(8, Value::integer(43));
+    CHECK(captured->lookup(8)->asInt() == 43);
+}
+
+#if FINESCRIPT_ATOMIC_REFCOUNT
+TEST_CASE("Scope frames may be freed on another thread", "[scope][thread]") {
+    auto layout = std::make_shared<ScopeLayout>();
+    layout->names = {7, 8};
+    auto global = Scope::createGlobal();
+
+    // Hand frames to a thread that drops them while this one allocates more
+    std::vector<std::shared_ptr<Scope>> handed;
+    for (int i = 0; i < 2000; i++) handed.push_back(global->createChild(layout));
+    std::thread dropper([frames = std::move(handed)]() mutable { frames.clear(); });
+    for (int i = 0; i < 2000; i++) {
+        auto frame = global->createChild(layout);
+        frame->bindSlot(0, Value::integer(i));
+        CHECK(frame->lookup(7)->asInt() == i);
+    }
+    dropper.join();
+    global.reset();
+}
+#endif
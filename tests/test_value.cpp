@@ -3,6 +3,8 @@
 #include "finescript/map_data.h"
 #include "finescript/interner.h"
 #include "finescript/native_function.h"
+#include "finescript/thread_handoff.h"
+#include <thread>
 
 using namespace finescript;
 
@@ -90,6 +92,43 @@ TEST_CASE("Value string", "[value]") {
     CHECK(empty.asString() == "");
 }
 
+TEST_CASE("Value shared strings copy on write", "[value]") {
+    auto literal = Value::sharedString("label");
+    auto a = literal;
+    auto b = literal;
+    CHECK(&a.asString() == &literal.asString());  // no copy to read
+
+    a.asStringMut() += "!";
+    CHECK(a.asString() == "label!");
+    CHECK(b.asString() == "label");
+    CHECK(literal.asString() == "label");
+
+    // The copy is an ordinary string: its own aliases see later changes
+    auto alias = a;
+    a.asStringMut() += "?";
+    CHECK(alias.asString() == "label!?");
+}
+
+TEST_CASE("Value appends in place only to unaliased strings", "[value]") {
+    auto s = Value::string("ab");
+    auto held = s;
+    const std::string* storage = &s.asString();
+    REQUIRE(s.appendInPlace(held, "cd"));
+    CHECK(held.isNil());
+    CHECK(s.asString() == "abcd");
+    CHECK(&s.asString() == storage);
+
+    held = s;
+    auto alias = s;
+    CHECK_FALSE(s.appendInPlace(held, "!"));
+    CHECK(held.asString() == "abcd");
+
+    auto literal = Value::sharedString("lit");
+    held = literal;
+    CHECK_FALSE(literal.appendInPlace(held, "!"));
+    CHECK_FALSE(s.appendInPlace(literal, "!"));  // not the same string
+}
+
 TEST_CASE("Value array", "[value]") {
     auto v = Value::array({Value::integer(1), Value::integer(2), Value::integer(3)});
     CHECK(v.isArray());
@@ -104,6 +143,43 @@ TEST_CASE("Value array", "[value]") {
     CHECK(empty.truthy()); // empty array is truthy
 }
 
+TEST_CASE("Value range is a lazy array", "[value]") {
+    auto v = Value::range(2, 5);
+    CHECK(v.isArray());
+    CHECK(v.type() == Value::Type::Array);
+    CHECK(v.typeName() == "array");
+    REQUIRE(v.lazyRange() != nullptr);
+    CHECK(v.lazyRange()->size() == 3);
+    CHECK(v.toString() == "[2 3 4]");
+    CHECK(v == Value::array({Value::integer(2), Value::integer(3), Value::integer(4)}));
+    CHECK(v == Value::range(2, 5));
+    CHECK(v != Value::range(2, 6));
+    CHECK(Value::range(3, 1) == Value::array(std::vector<Value>{}));
+    CHECK(v.lazyRange() != nullptr);  // none of the above materialized it
+
+    // Mutation materializes once; other copies share the array
+    Value copy = v;
+    v.asArrayMut().push_back(Value::integer(9));
+    CHECK(v.lazyRange() == nullptr);
+    CHECK(copy.lazyRange() == nullptr);
+    REQUIRE(copy.asArray().size() == 4);
+    CHECK(copy.asArray()[3].asInt() == 9);
+}
+
+TEST_CASE("Value range materializes once across threads", "[value]") {
+    const auto v = Value::range(0, 10000);
+    std::vector<const std::vector<Value>*> seen(4, nullptr);
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < seen.size(); t++) {
+        readers.emplace_back([&, t] { seen[t] = &v.asArray(); });
+    }
+    for (auto& reader : readers) reader.join();
+    for (auto* arr : seen) CHECK(arr == seen[0]);
+    REQUIRE(seen[0]->size() == 10000);
+    CHECK((*seen[0])[9999].asInt() == 9999);
+    CHECK(v.lazyRange() == nullptr);
+}
+
 TEST_CASE("Value map", "[value]") {
     auto v = Value::map();
     CHECK(v.isMap());
@@ -118,6 +194,51 @@ TEST_CASE("Value map", "[value]") {
     CHECK(v.asMap().get(1).isNil());
 }
 
+TEST_CASE("Value heap objects share ownership with host shared_ptrs", "[value]") {
+    // A map created by the host stays the same object on both sides
+    auto hostMap = std::make_shared<MapData>();
+    {
+        auto v = Value::map(hostMap);
+        auto copy = v;
+        copy.asMap().set(1, Value::integer(10));
+        CHECK(hostMap->get(1).asInt() == 10);
+        CHECK(copy.mapPtr() == hostMap);
+    }
+    CHECK(hostMap.use_count() == 1);
+    hostMap->set(2, Value::integer(20));
+    CHECK(Value::map(hostMap).asMap().get(2).asInt() == 20);
+
+    // A pointer taken from a script-created value keeps it alive
+    std::shared_ptr<MapData> held;
+    {
+        auto v = Value::map();
+        v.asMap().set(3, Value::integer(30));
+        held = v.mapPtr();
+    }
+    CHECK(held->get(3).asInt() == 30);
+    auto again = Value::map(held);
+    CHECK(again.mapPtr() == held);
+
+    std::shared_ptr<std::string> str;
+    {
+        auto v = Value::string("hello");
+        str = v.stringPtr();
+        v.asStringMut() += "!";
+    }
+    CHECK(*str == "hello!");
+}
+
+TEST_CASE("Value scalars are stored inline", "[value]") {
+    CHECK(sizeof(Value) == 16);
+    auto a = Value::integer(INT64_MIN);
+    auto b = a;
+    CHECK(b.asInt() == INT64_MIN);
+    b = Value::string("s");
+    b = Value::number(-0.5);
+    CHECK(b.asFloat() == -0.5);
+    CHECK(Value::symbol(UINT32_MAX).asSymbol() == UINT32_MAX);
+}
+
 TEST_CASE("Value closure", "[value]") {
     auto c = std::make_shared<Closure>();
     c->name = "test_fn";
@@ -131,7 +252,7 @@ TEST_CASE("Value closure", "[value]") {
 
 TEST_CASE("Value native function", "[value]") {
     auto fn = std::make_shared<SimpleLambdaFunction>(
-        [](ExecutionContext&, const std::vector<Value>&) { return Value::nil(); }
+        [](ExecutionContext&, ArgSpan) { return Value::nil(); }
     );
     auto v = Value::nativeFunction(fn);
     CHECK(v.isNativeFunction());
@@ -215,7 +336,7 @@ TEST_CASE("Value type names", "[value]") {
 TEST_CASE("MapData method flags", "[value][map]") {
     auto m = Value::map();
     auto fn = std::make_shared<SimpleLambdaFunction>(
-        [](ExecutionContext&, const std::vector<Value>&) { return Value::nil(); }
+        [](ExecutionContext&, ArgSpan) { return Value::nil(); }
     );
 
     // Regular set — not a method
@@ -231,6 +352,114 @@ TEST_CASE("MapData method flags", "[value][map]") {
     CHECK_FALSE(m.asMap().isMethod(2));
 }
 
+TEST_CASE("MapData cached lookups follow map changes", "[value][map]") {
+    auto m = Value::map();
+    auto other = Value::map();
+    m.asMap().set(1, Value::integer(10));
+    other.asMap().set(1, Value::integer(20));
+
+    FieldCache cache;
+    Value out;
+    bool method = false;
+    REQUIRE(m.asMap().lookup(1, cache, out, method));
+    CHECK(out.asInt() == 10);
+    CHECK(m.asMap().get(1, cache).asInt() == 10);        // hit
+    CHECK(other.asMap().get(1, cache).asInt() == 20);    // other map misses
+
+    // Value updates go through the cached entry; key changes invalidate it
+    m.asMap().set(1, Value::integer(11));
+    CHECK(m.asMap().get(1, cache).asInt() == 11);
+    m.asMap().set(1, Value::integer(12), cache);
+    CHECK(m.asMap().get(1) == Value::integer(12));
+    m.asMap().markMethod(1);
+    REQUIRE(m.asMap().lookup(1, cache, out, method));
+    CHECK(method);
+    m.asMap().remove(1);
+    CHECK_FALSE(m.asMap().lookup(1, cache, out, method));
+    CHECK(m.asMap().get(1, cache).isNil());
+    m.asMap().set(1, Value::integer(13));
+    CHECK(m.asMap().get(1, cache).asInt() == 13);
+
+    // A copy shares the shape but not the values
+    MapData copy(m.asMap());
+    CHECK(m.asMap().get(1, cache).asInt() == 13);
+    copy.set(1, Value::integer(14), cache);
+    CHECK(m.asMap().get(1).asInt() == 13);
+    CHECK(copy.get(1).asInt() == 14);
+}
+
+TEST_CASE("MapData maps with the same keys share a shape", "[value][map]") {
+    auto a = Value::map();
+    auto b = Value::map();
+    for (uint32_t key : {5u, 6u, 7u}) {
+        a.asMap().set(key, Value::integer(key));
+        b.asMap().set(key, Value::integer(key * 10));
+    }
+    REQUIRE(a.asMap().shape() != nullptr);
+    CHECK(a.asMap().shape() == b.asMap().shape());
+    CHECK(a.asMap().keys() == std::vector<uint32_t>{5, 6, 7});
+
+    // One cache serves every map of the shape
+    FieldCache cache;
+    CHECK(a.asMap().get(6, cache).asInt() == 6);
+    CHECK(cache.shape == a.asMap().shape());
+    CHECK(b.asMap().get(6, cache).asInt() == 60);
+
+    // Method marks are part of the shape
+    b.asMap().markMethod(7);
+    CHECK(a.asMap().shape() != b.asMap().shape());
+    CHECK(b.asMap().isMethod(7));
+    CHECK_FALSE(a.asMap().isMethod(7));
+    Value out;
+    bool method = false;
+    REQUIRE(b.asMap().lookup(7, cache, out, method));
+    CHECK(method);
+}
+
+TEST_CASE("MapData shapes are shared across threads", "[value][map]") {
+    // Each thread builds maps whose first keys fan out from the empty shape,
+    // so the threads race to add and look up the same transitions
+    constexpr uint32_t kBase = 900000;
+    constexpr uint32_t kKeys = 200;
+    std::vector<std::vector<const Shape*>> shapes(4);
+    std::vector<std::thread> builders;
+    for (size_t t = 0; t < shapes.size(); t++) {
+        builders.emplace_back([&, t] {
+            for (uint32_t k = 0; k < kKeys; k++) {
+                MapData m;
+                m.set(kBase + k, Value::integer(k));
+                m.set(kBase + kKeys, Value::integer(t));
+                shapes[t].push_back(m.shape());
+            }
+        });
+    }
+    for (auto& builder : builders) builder.join();
+    for (size_t t = 1; t < shapes.size(); t++) CHECK(shapes[t] == shapes[0]);
+    for (const Shape* shape : shapes[0]) {
+        REQUIRE(shape != nullptr);
+        CHECK(shape->size() == 2);
+    }
+}
+
+TEST_CASE("MapData falls back to dictionary mode", "[value][map]") {
+    auto removed = Value::map();
+    removed.asMap().set(1, Value::integer(1));
+    removed.asMap().setMethod(2, Value::integer(2));
+    CHECK(removed.asMap().remove(1));
+    CHECK(removed.asMap().shape() == nullptr);
+    CHECK_FALSE(removed.asMap().has(1));
+    CHECK(removed.asMap().get(2).asInt() == 2);
+    CHECK(removed.asMap().isMethod(2));
+
+    auto big = Value::map();
+    for (uint32_t key = 0; key < 100; key++) big.asMap().set(key, Value::integer(key));
+    CHECK(big.asMap().shape() == nullptr);
+    CHECK(big.asMap().keys().size() == 100);
+    FieldCache cache;
+    CHECK(big.asMap().get(42, cache).asInt() == 42);
+    CHECK(big.asMap().get(42, cache).asInt() == 42);
+}
+
 TEST_CASE("MapData keys", "[value][map]") {
     auto m = Value::map();
     m.asMap().set(10, Value::integer(1));
@@ -245,3 +474,59 @@ TEST_CASE("MapData keys", "[value][map]") {
     CHECK(keys[1] == 20);
     CHECK(keys[2] == 30);
 }
+
+TEST_CASE("MapData iterates in insertion order", "[value][map]") {
+    auto m = Value::map();
+    for (uint32_t key : {30u, 10u, 20u}) m.asMap().set(key, Value::integer(key));
+    CHECK(m.asMap().keys() == std::vector<uint32_t>{30, 10, 20});
+
+    // Dictionary mode keeps the order across removals and compaction
+    auto d = Value::map();
+    for (uint32_t key = 100; key > 0; key--) d.asMap().set(key, Value::integer(key));
+    for (uint32_t key = 100; key > 0; key -= 2) CHECK(d.asMap().remove(key));
+    CHECK_FALSE(d.asMap().remove(100));
+    d.asMap().set(100, Value::integer(-1));
+    d.asMap().set(99, Value::integer(-99));
+    CHECK(d.asMap().size() == 51);
+
+    std::vector<uint32_t> keys;
+    std::vector<int64_t> values;
+    d.asMap().forEach([&](uint32_t key, const Value& value) {
+        keys.push_back(key);
+        values.push_back(value.asInt());
+    });
+    REQUIRE(keys.size() == 51);
+    CHECK(keys.front() == 99);
+    CHECK(values.front() == -99);
+    CHECK(keys[1] == 97);
+    CHECK(keys.back() == 100);
+    CHECK(values.back() == -1);
+    CHECK(d.asMap().keys() == keys);
+    CHECK(d.asMap().values().size() == 51);
+}
+
+TEST_CASE("ThreadHandoff deep-copies data for another thread", "[value][thread]") {
+    auto shared = Value::map();
+    shared.asMap().set(1, Value::string("hp"));
+    auto original = Value::array({shared, shared, Value::range(0, 3), Value::integer(7)});
+
+    ThreadHandoff handoff(original);
+    shared.asMap().set(1, Value::string("changed"));
+
+    Value received;
+    std::thread receiver([&] { received = handoff.take(); });
+    receiver.join();
+
+    auto& arr = received.asArray();
+    REQUIRE(arr.size() == 4);
+    CHECK(arr[0].asMap().get(1).asString() == "hp");
+    CHECK(arr[0] == arr[1]);               // aliasing inside the value survives
+    CHECK_FALSE(arr[0] == shared);         // but nothing is shared with the sender
+    CHECK(arr[2].lazyRange() != nullptr);
+    CHECK(arr[3].asInt() == 7);
+    CHECK_THROWS_AS(handoff.take(), std::logic_error);
+
+    auto fnMap = Value::map();
+    fnMap.asMap().set(1, Value::closure(std::make_shared<Closure>()));
+    CHECK_THROWS_AS(ThreadHandoff(fnMap), std::runtime_error);
+}